@@ -21,6 +21,13 @@ void bidirectional_stream_copy( Socket& socket )
   bool _outbound_shutdown { false };
   bool _inbound_shutdown { false };
 
+  // readiness of each stream, kept up to date by its watermark callbacks instead of being re-checked
+  bool _outbound_writable {}, _outbound_readable {}, _inbound_writable {}, _inbound_readable {};
+  _outbound.writer().on_writable( 1, [&]( bool ready ) { _outbound_writable = ready; } );
+  _outbound.reader().on_readable( 1, [&]( bool ready ) { _outbound_readable = ready; } );
+  _inbound.writer().on_writable( 1, [&]( bool ready ) { _inbound_writable = ready; } );
+  _inbound.reader().on_readable( 1, [&]( bool ready ) { _inbound_readable = ready; } );
+
   socket.set_blocking( false );
   _input.set_blocking( false );
   _output.set_blocking( false );
@@ -31,17 +38,13 @@ void bidirectional_stream_copy( Socket& socket )
     _input,
     Direction::In,
     [&] {
-      string data;
-      data.resize( _outbound.writer().available_capacity() );
-      _input.read( data );
-      _outbound.writer().push( move( data ) );
+      _outbound.writer().push_from( _input );
       if ( _input.eof() ) {
         _outbound.writer().close();
       }
     },
     [&] {
-      return ( not _outbound.reader().has_error() ) and ( _outbound.writer().available_capacity() > 0 )
-             and ( not _inbound.reader().has_error() );
+      return ( not _outbound.reader().has_error() ) and _outbound_writable and ( not _inbound.reader().has_error() );
     },
     [&] { _outbound.writer().close(); } );
 
@@ -52,16 +55,14 @@ void bidirectional_stream_copy( Socket& socket )
     Direction::Out,
     [&] {
       if ( _outbound.reader().bytes_buffered() ) {
-        _outbound.reader().pop( socket.write( _outbound.reader().peek() ) );
+        _outbound.reader().pop( socket.write( _outbound.reader().peek_all() ) );
       }
       if ( _outbound.reader().is_finished() ) {
         socket.shutdown( SHUT_WR );
         _outbound_shutdown = true;
       }
     },
-    [&] {
-      return _outbound.reader().bytes_buffered() or ( _outbound.reader().is_finished() and not _outbound_shutdown );
-    },
+    [&] { return _outbound_readable and not _outbound_shutdown; },
     [&] { _outbound.writer().close(); } );
 
   // rule 3: read from socket into inbound byte stream
@@ -70,17 +71,13 @@ void bidirectional_stream_copy( Socket& socket )
     socket,
     Direction::In,
     [&] {
-      string data;
-      data.resize( _inbound.writer().available_capacity() );
-      socket.read( data );
-      _inbound.writer().push( move( data ) );
+      _inbound.writer().push_from( socket );
       if ( socket.eof() ) {
         _inbound.writer().close();
       }
     },
     [&] {
-      return ( not _inbound.reader().has_error() ) and ( _inbound.writer().available_capacity() > 0 )
-             and ( not _outbound.reader().has_error() );
+      return ( not _inbound.reader().has_error() ) and _inbound_writable and ( not _outbound.reader().has_error() );
     },
     [&] { _inbound.writer().close(); } );
 
@@ -91,16 +88,14 @@ void bidirectional_stream_copy( Socket& socket )
     Direction::Out,
     [&] {
       if ( _inbound.reader().bytes_buffered() ) {
-        _inbound.reader().pop( _output.write( _inbound.reader().peek() ) );
+        _inbound.reader().pop( _output.write( _inbound.reader().peek_all() ) );
       }
       if ( _inbound.reader().is_finished() ) {
         _output.close();
         _inbound_shutdown = true;
       }
     },
-    [&] {
-      return _inbound.reader().bytes_buffered() or ( _inbound.reader().is_finished() and not _inbound_shutdown );
-    },
+    [&] { return _inbound_readable and not _inbound_shutdown; },
     [&] { _inbound.writer().close(); } );
 
   // loop until completion
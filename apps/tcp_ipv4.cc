@@ -34,6 +34,11 @@ static void show_usage( const char* argv0, const char* msg )
 
        << "   -t <tmout>      Set rt_timeout to tmout                         " << TCPConfig::TIMEOUT_DFLT << "\n\n"
 
+       << "   -m <mss>        Offer a maximum segment size of <mss> bytes     " << TCPConfig::MAX_PAYLOAD_SIZE
+       << "\n"
+       << "   -P              Probe the path for larger segments (PLPMTUD)    (off)\n"
+       << "   -N              Coalesce small writes (Nagle's algorithm)       (off)\n\n"
+
        << "   -d <tundev>     Connect to tun <tundev>                         " << TUN_DFLT << "\n\n"
 
        << "   -Lu <loss>      Set uplink loss to <rate> (float in 0..1)       (no loss)\n"
@@ -93,6 +98,19 @@ static tuple<TCPConfig, FdAdapterConfig, bool, const char*> get_config( const sp
       c_fsm.rt_timeout = strtol( args[curr + 1], nullptr, 0 );
       curr += 2;
 
+    } else if ( strncmp( "-m", args[curr], 3 ) == 0 ) {
+      check_argc( args, curr, "ERROR: -m requires one argument." );
+      c_fsm.mss = static_cast<uint16_t>( strtol( args[curr + 1], nullptr, 0 ) );
+      curr += 2;
+
+    } else if ( strncmp( "-P", args[curr], 3 ) == 0 ) {
+      c_fsm.plpmtud = true;
+      curr += 1;
+
+    } else if ( strncmp( "-N", args[curr], 3 ) == 0 ) {
+      c_fsm.nagle = true;
+      curr += 1;
+
     } else if ( strncmp( "-d", args[curr], 3 ) == 0 ) {
       check_argc( args, curr, "ERROR: -t requires one argument." );
       tundev = args[curr + 1];
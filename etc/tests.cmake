@@ -1,6 +1,6 @@
 include(CTest)
 
-list(APPEND CMAKE_CTEST_ARGUMENTS --output-on-failure --stop-on-failure --timeout 10 -E 'speed_test|optimization')
+list(APPEND CMAKE_CTEST_ARGUMENTS --output-on-failure --stop-on-failure --timeout 10 -E 'speed_test|benchmark|optimization')
 
 set(compile_name "compile with bug-checkers")
 add_test(NAME ${compile_name}
@@ -11,6 +11,12 @@ macro (ttest name)
   set_property(TEST ${name} PROPERTY FIXTURES_REQUIRED compile)
 endmacro (ttest)
 
+macro (ttest_storage name storage)
+  add_test(NAME ${name}_${storage} COMMAND "${name}_sanitized")
+  set_property(TEST ${name}_${storage} PROPERTY FIXTURES_REQUIRED compile)
+  set_property(TEST ${name}_${storage} PROPERTY ENVIRONMENT "MINNOW_BYTE_STREAM_STORAGE=${storage}")
+endmacro (ttest_storage)
+
 set_property(TEST ${compile_name} PROPERTY TIMEOUT -1)
 set_tests_properties(${compile_name} PROPERTIES FIXTURES_SETUP compile)
 
@@ -23,6 +29,26 @@ ttest(byte_stream_one_write)
 ttest(byte_stream_two_writes)
 ttest(byte_stream_many_writes)
 ttest(byte_stream_stress_test)
+ttest(byte_stream_watermarks)
+ttest(byte_stream_resize)
+
+ttest_storage(byte_stream_basics chunked)
+ttest_storage(byte_stream_capacity chunked)
+ttest_storage(byte_stream_one_write chunked)
+ttest_storage(byte_stream_two_writes chunked)
+ttest_storage(byte_stream_many_writes chunked)
+ttest_storage(byte_stream_stress_test chunked)
+ttest_storage(byte_stream_watermarks chunked)
+ttest_storage(byte_stream_resize chunked)
+
+ttest_storage(byte_stream_basics mirrored)
+ttest_storage(byte_stream_capacity mirrored)
+ttest_storage(byte_stream_one_write mirrored)
+ttest_storage(byte_stream_two_writes mirrored)
+ttest_storage(byte_stream_many_writes mirrored)
+ttest_storage(byte_stream_stress_test mirrored)
+ttest_storage(byte_stream_watermarks mirrored)
+ttest_storage(byte_stream_resize mirrored)
 
 ttest(reassembler_single)
 ttest(reassembler_cap)
@@ -31,12 +57,14 @@ ttest(reassembler_dup)
 ttest(reassembler_holes)
 ttest(reassembler_overlapping)
 ttest(reassembler_win)
+ttest(reassembler_budget)
 
 ttest(wrapping_integers_cmp)
 ttest(wrapping_integers_wrap)
 ttest(wrapping_integers_unwrap)
 ttest(wrapping_integers_roundtrip)
 ttest(wrapping_integers_extra)
+ttest(wrapping_integers_serial)
 
 ttest(recv_connect)
 ttest(recv_transmit)
@@ -45,6 +73,8 @@ ttest(recv_reorder)
 ttest(recv_reorder_more)
 ttest(recv_close)
 ttest(recv_special)
+ttest(recv_sack)
+ttest(segment_options)
 
 ttest(send_connect)
 ttest(send_transmit)
@@ -53,6 +83,22 @@ ttest(send_window)
 ttest(send_ack)
 ttest(send_close)
 ttest(send_extra)
+ttest(send_congestion)
+ttest(send_rto)
+ttest(send_fast_retx)
+ttest(send_sack_recovery)
+ttest(send_plpmtud)
+ttest(send_nagle)
+
+ttest(peer_delayed_ack)
+ttest(peer_window_scale)
+ttest(peer_recv_autotune)
+ttest(peer_fast_retx)
+ttest(peer_plpmtud)
+ttest(peer_nagle)
+
+ttest(spsc_channel_threads)
+ttest(socket_shared_transport)
 
 ttest(net_interface)
 
@@ -74,7 +120,7 @@ add_custom_target (check5 COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure --s
 
 ###
 
-add_custom_target (speed COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure --timeout 12 -R '_speed_test')
+add_custom_target (speed COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure --timeout 12 -R '_speed_test|_benchmark')
 
 set(compile_name_opt "compile with optimization")
 add_test(NAME ${compile_name_opt}
@@ -90,3 +136,7 @@ set_tests_properties(${compile_name_opt} PROPERTIES FIXTURES_SETUP compile_opt)
 
 stest(byte_stream_speed_test)
 stest(reassembler_speed_test)
+stest(byte_stream_benchmark)
+stest(reassembler_benchmark)
+stest(wrapping_integers_benchmark)
+stest(sender_benchmark)
@@ -1,21 +1,165 @@
 #include "byte_stream.hh"
+#include "file_descriptor.hh"
+
+#include <cstring>
 
 using namespace std;
 
-ByteStream::ByteStream( uint64_t capacity )
-  : buffer_(), capacity_( capacity ), bytes_pushed_( 0 ), bytes_popped_( 0 ), is_close_( false ), error_( false )
+ByteStream::ByteStream( uint64_t capacity, Storage storage )
+  : storage_( storage )
+  , buffer_( storage == Storage::Ring ? capacity : 0, '\0' )
+  , mirror_( storage == Storage::Mirrored ? MirroredBuffer( capacity ) : MirroredBuffer() )
+  , capacity_( capacity )
+  , bytes_pushed_( 0 )
+  , bytes_popped_( 0 )
+  , is_close_( false )
+  , error_( false )
 {}
 
+void ByteStream::update_watermarks()
+{
+  if ( readable_watermark_.callback ) {
+    const bool readable = reader().bytes_buffered() >= readable_watermark_.level || is_close_ || error_;
+    if ( readable != readable_watermark_.state ) {
+      readable_watermark_.state = readable;
+      readable_watermark_.callback( readable );
+    }
+  }
+
+  if ( writable_watermark_.callback ) {
+    const bool writable = writer().available_capacity() >= writable_watermark_.level;
+    if ( writable != writable_watermark_.state ) {
+      writable_watermark_.state = writable;
+      writable_watermark_.callback( writable );
+    }
+  }
+}
+
+void ByteStream::set_capacity( uint64_t capacity )
+{
+  capacity = max( capacity, reader().bytes_buffered() );
+
+  if ( capacity == capacity_ )
+    return;
+
+  // keep storage that fits with little to spare: reallocating copies everything buffered, and a
+  // receive buffer being tuned down shrinks a little at a time
+  const uint64_t needed = storage_ == Storage::Mirrored ? MirroredBuffer::mapped_size( capacity ) : capacity;
+  if ( storage_ == Storage::Chunked || ( needed <= ring_size() && ring_size() - needed <= ring_size() / 8 ) ) {
+    capacity_ = capacity;
+    update_watermarks();
+    return;
+  }
+
+  string buffer( storage_ == Storage::Ring ? capacity : 0, '\0' );
+  MirroredBuffer mirror = storage_ == Storage::Mirrored ? MirroredBuffer( capacity ) : MirroredBuffer();
+  char* data = storage_ == Storage::Mirrored ? mirror.data() : buffer.data();
+  const uint64_t size = storage_ == Storage::Mirrored ? mirror.size() : capacity;
+
+  // lay the buffered bytes out again at the positions of their stream indices in the new ring
+  uint64_t offset = size == 0 ? 0 : bytes_popped_ % size;
+  for ( const auto region : reader().peek_all() ) {
+    uint64_t first_len
+      = storage_ == Storage::Mirrored ? region.size() : min<uint64_t>( region.size(), size - offset );
+    memcpy( data + offset, region.data(), first_len );
+    memcpy( data, region.data() + first_len, region.size() - first_len );
+    offset = ( offset + region.size() ) % size;
+  }
+
+  buffer_ = std::move( buffer );
+  mirror_ = std::move( mirror );
+  capacity_ = capacity;
+
+  update_watermarks();
+}
+
+uint64_t ByteStream::contiguous_len( uint64_t offset, uint64_t len ) const
+{
+  // the second mapping of a mirrored ring continues where the first ends
+  return storage_ == Storage::Mirrored ? len : min( len, ring_size() - offset );
+}
+
 void Writer::push( string data )
 {
   uint64_t write_len = min( data.size(), available_capacity() );
-  Writer::buffer_ += data.substr( 0, write_len );
+
+  if ( write_len == 0 )
+    return;
+
+  if ( storage_ == Storage::Chunked ) {
+    data.resize( write_len );
+
+    // don't let a short string pin a much larger allocation
+    if ( data.capacity() > 4 * data.size() )
+      data.shrink_to_fit();
+
+    chunks_.push_back( std::move( data ) );
+    bytes_pushed_ += write_len;
+    update_watermarks();
+    return;
+  }
+
+  // copy into the free region, wrapping around the end of the ring if needed
+  uint64_t tail = bytes_pushed_ % ring_size();
+  uint64_t first_len = contiguous_len( tail, write_len );
+  memcpy( ring_data() + tail, data.data(), first_len );
+  memcpy( ring_data(), data.data() + first_len, write_len - first_len );
   bytes_pushed_ += write_len;
+  update_watermarks();
+}
+
+array<span<char>, 2> Writer::reserve( uint64_t len )
+{
+  len = min( len, available_capacity() );
+
+  if ( len == 0 )
+    return {};
+
+  if ( storage_ == Storage::Chunked ) {
+    reserved_chunk_.resize( len );
+    return { span( reserved_chunk_ ), span<char> {} };
+  }
+
+  uint64_t tail = bytes_pushed_ % ring_size();
+  uint64_t first_len = contiguous_len( tail, len );
+  return { span( ring_data() + tail, first_len ), span( ring_data(), len - first_len ) };
+}
+
+void Writer::commit( uint64_t len )
+{
+  len = min( len, available_capacity() );
+
+  if ( storage_ == Storage::Chunked ) {
+    reserved_chunk_.resize( min( len, reserved_chunk_.size() ) );
+    push( std::move( reserved_chunk_ ) );
+    reserved_chunk_.clear();
+    return;
+  }
+
+  bytes_pushed_ += len;
+  update_watermarks();
+}
+
+uint64_t Writer::push_from( FileDescriptor& fd )
+{
+  const auto regions = reserve( available_capacity() );
+  const uint64_t bytes_read = fd.read( regions );
+  commit( bytes_read );
+  return bytes_read;
+}
+
+void Writer::on_writable( uint64_t low_watermark, function<void( bool )> callback )
+{
+  writable_watermark_ = { low_watermark, std::move( callback ), available_capacity() >= low_watermark };
+
+  if ( writable_watermark_.callback )
+    writable_watermark_.callback( writable_watermark_.state );
 }
 
 void Writer::close()
 {
   is_close_ = true;
+  update_watermarks();
 }
 
 bool Writer::is_closed() const
@@ -25,7 +169,7 @@ bool Writer::is_closed() const
 
 uint64_t Writer::available_capacity() const
 {
-  return capacity_ - buffer_.size();
+  return capacity_ - ( bytes_pushed_ - bytes_popped_ );
 }
 
 uint64_t Writer::bytes_pushed() const
@@ -35,28 +179,82 @@ uint64_t Writer::bytes_pushed() const
 
 string_view Reader::peek() const
 {
-  std::string_view sv1( buffer_ );
-  return { sv1 };
+  if ( bytes_buffered() == 0 )
+    return {};
+
+  if ( storage_ == Storage::Chunked )
+    return string_view( chunks_.front() ).substr( chunk_offset_ );
+
+  // only the contiguous part up to the end of the ring is visible at once
+  uint64_t head = bytes_popped_ % ring_size();
+  return { ring_data() + head, contiguous_len( head, bytes_buffered() ) };
+}
+
+vector<string_view> Reader::peek_all() const
+{
+  vector<string_view> regions;
+
+  if ( bytes_buffered() == 0 )
+    return regions;
+
+  if ( storage_ == Storage::Chunked ) {
+    regions.reserve( chunks_.size() );
+    regions.push_back( peek() );
+
+    for ( auto iter = next( chunks_.begin() ); iter != chunks_.end(); ++iter )
+      regions.emplace_back( *iter );
+
+    return regions;
+  }
+
+  // the ring holds at most two regions: up to the end of the storage, then the wrapped part
+  regions.push_back( peek() );
+
+  if ( regions.front().size() < bytes_buffered() )
+    regions.emplace_back( ring_data(), bytes_buffered() - regions.front().size() );
+
+  return regions;
 }
 
 void Reader::pop( uint64_t len )
 {
   uint64_t pop_len = min( len, bytes_buffered() );
-  Reader::buffer_.erase( 0, pop_len );
   bytes_popped_ += pop_len;
+
+  if ( storage_ == Storage::Chunked ) {
+    // drop the chunks that were fully consumed, then advance into the new front
+    while ( pop_len > 0 && pop_len >= chunks_.front().size() - chunk_offset_ ) {
+      pop_len -= chunks_.front().size() - chunk_offset_;
+      chunks_.pop_front();
+      chunk_offset_ = 0;
+    }
+
+    chunk_offset_ += pop_len;
+  }
+
+  update_watermarks();
+}
+
+void Reader::on_readable( uint64_t low_watermark, function<void( bool )> callback )
+{
+  readable_watermark_
+    = { low_watermark, std::move( callback ), bytes_buffered() >= low_watermark || is_close_ || error_ };
+
+  if ( readable_watermark_.callback )
+    readable_watermark_.callback( readable_watermark_.state );
 }
 
 bool Reader::is_finished() const
 {
-  return is_close_ && buffer_.empty();
+  return is_close_ && bytes_buffered() == 0;
 }
 
 uint64_t Reader::bytes_buffered() const
 {
-  return buffer_.size();
+  return bytes_pushed_ - bytes_popped_;
 }
 
 uint64_t Reader::bytes_popped() const
 {
   return bytes_popped_;
-}
\ No newline at end of file
+}
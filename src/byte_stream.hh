@@ -1,16 +1,32 @@
 #pragma once
 
+#include "mirrored_buffer.hh"
+
+#include <array>
 #include <cstdint>
+#include <deque>
+#include <functional>
+#include <span>
 #include <string>
 #include <string_view>
+#include <vector>
 
+class FileDescriptor;
 class Reader;
 class Writer;
 
 class ByteStream
 {
 public:
-  explicit ByteStream( uint64_t capacity );
+  // How the buffered bytes are held
+  enum class Storage
+  {
+    Ring,     // Copied into a fixed-capacity ring allocated at construction
+    Chunked,  // Pushed strings are adopted as-is and handed to the reader without copying
+    Mirrored, // Like Ring, but mapped twice back-to-back so peek() always sees every buffered byte
+  };
+
+  explicit ByteStream( uint64_t capacity, Storage storage = Storage::Ring );
 
   // Helper functions (provided) to access the ByteStream's Reader and Writer interfaces
   Reader& reader();
@@ -18,17 +34,49 @@ public:
   Writer& writer();
   const Writer& writer() const;
 
-  void set_error() { error_ = true; };       // Signal that the stream suffered an error.
+  void set_error()                           // Signal that the stream suffered an error.
+  {
+    error_ = true;
+    update_watermarks();
+  };
   bool has_error() const { return error_; }; // Has the stream had an error?
+  Storage storage() const { return storage_; }
+
+  // Change the capacity (never below what is buffered); Ring and Mirrored storage is reallocated unless
+  // it already fits the new capacity with at most an eighth to spare
+  void set_capacity( uint64_t capacity );
+  uint64_t capacity() const { return capacity_; }
 
 protected:
   // Please add any additional state to the ByteStream here, and not to the Writer and Reader interfaces.
-  std::string buffer_; // Buffer to store the data
+  Storage storage_;
+  std::string buffer_; // Ring storage of at least `capacity_` bytes (Ring)
+  std::deque<std::string> chunks_ {}; // Pushed strings, oldest first (Chunked)
+  uint64_t chunk_offset_ {};          // Bytes already popped from chunks_.front() (Chunked)
+  std::string reserved_chunk_ {};     // Space handed out by Writer::reserve() (Chunked)
+  MirroredBuffer mirror_ {};          // Ring storage that never wraps, rounded up to whole pages (Mirrored)
   uint64_t capacity_;
   uint64_t bytes_pushed_;
   uint64_t bytes_popped_;
   bool is_close_;
   bool error_ {};
+
+  // Ring and Mirrored storage
+  uint64_t ring_size() const { return storage_ == Storage::Mirrored ? mirror_.size() : buffer_.size(); }
+  char* ring_data() { return storage_ == Storage::Mirrored ? mirror_.data() : buffer_.data(); }
+  const char* ring_data() const { return storage_ == Storage::Mirrored ? mirror_.data() : buffer_.data(); }
+  uint64_t contiguous_len( uint64_t offset, uint64_t len ) const; // Bytes of `len` at `offset` before a wrap
+
+  // A threshold whose callback runs each time the condition it guards starts or stops holding
+  struct Watermark
+  {
+    uint64_t level {};
+    std::function<void( bool )> callback {};
+    bool state {};
+  };
+  Watermark readable_watermark_ {};
+  Watermark writable_watermark_ {};
+  void update_watermarks(); // Run the callbacks whose condition changed
 };
 
 class Writer : public ByteStream
@@ -37,6 +85,23 @@ public:
   void push( std::string data ); // Push data to stream, but only as much as available capacity allows.
   void close();                  // Signal that the stream has reached its ending. Nothing more will be written.
 
+  /*
+   * Write into the stream's own free space instead of pushing a string:
+   * reserve() returns up to `len` bytes of free space (split in two if the ring wraps), and
+   * commit() makes the first `len` bytes written there readable. Any other call to the Writer
+   * invalidates the reserved regions.
+   */
+  std::array<std::span<char>, 2> reserve( uint64_t len );
+  void commit( uint64_t len );
+
+  // Read as much as available capacity allows from `fd` directly into the stream; returns bytes read
+  uint64_t push_from( FileDescriptor& fd );
+
+  // Call `callback( true )` when available_capacity() rises to `low_watermark` and `callback( false )`
+  // when it falls below it again; also called right away with the current state. The callback must not
+  // modify the stream.
+  void on_writable( uint64_t low_watermark, std::function<void( bool )> callback );
+
   bool is_closed() const;              // Has the stream been closed?
   uint64_t available_capacity() const; // How many bytes can be pushed to the stream right now?
   uint64_t bytes_pushed() const;       // Total number of bytes cumulatively pushed to the stream
@@ -45,8 +110,14 @@ public:
 class Reader : public ByteStream
 {
 public:
-  std::string_view peek() const; // Peek at the next bytes in the buffer
-  void pop( uint64_t len );      // Remove `len` bytes from the buffer
+  std::string_view peek() const;                 // Peek at the next bytes in the buffer
+  std::vector<std::string_view> peek_all() const; // Peek at every buffered region, in order (e.g. for writev)
+  void pop( uint64_t len );                      // Remove `len` bytes from the buffer
+
+  // Call `callback( true )` when bytes_buffered() rises to `low_watermark` (or the stream is closed or has
+  // an error) and `callback( false )` when that stops holding; also called right away with the current
+  // state. A watermark above 1 lets the reader wait for a batch. The callback must not modify the stream.
+  void on_readable( uint64_t low_watermark, std::function<void( bool )> callback );
 
   bool is_finished() const;        // Is the stream finished (closed and fully popped)?
   uint64_t bytes_buffered() const; // Number of bytes currently buffered (pushed and not popped)
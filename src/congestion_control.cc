@@ -0,0 +1,155 @@
+#include "congestion_control.hh"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+unique_ptr<CongestionControl> CongestionControl::make( Algorithm algorithm, uint64_t mss )
+{
+  switch ( algorithm ) {
+    case Algorithm::NewReno:
+      return make_unique<NewReno>( mss );
+
+    case Algorithm::Cubic:
+      return make_unique<Cubic>( mss );
+
+    default:
+      return nullptr;
+  }
+}
+
+// initial window (RFC 5681 3.1)
+uint64_t CongestionControl::initial_window( uint64_t mss )
+{
+  return mss > 2190 ? 2 * mss : mss > 1095 ? 3 * mss : 4 * mss;
+}
+
+CongestionControl::CongestionControl( uint64_t mss ) : mss_( mss ), cwnd_( initial_window( mss ) ) {}
+
+void CongestionControl::set_mss( uint64_t mss )
+{
+  if ( cwnd_ == initial_window( mss_ ) && ssthresh_ == UINT64_MAX )
+    cwnd_ = initial_window( mss );
+
+  mss_ = mss;
+}
+
+void CongestionControl::on_rtt_sample( uint64_t rtt_ms [[maybe_unused]] ) {}
+
+void CongestionControl::deflate( uint64_t bytes_acked )
+{
+  // add back a segment if the partial ACK covered one, as it lets a new segment out (RFC 6582 3.2)
+  cwnd_ -= min( bytes_acked, cwnd_ );
+  cwnd_ = max( cwnd_ + ( bytes_acked >= mss_ ? mss_ : 0 ), mss_ );
+}
+
+void CongestionControl::slow_start( uint64_t bytes_acked )
+{
+  cwnd_ += min( bytes_acked, mss_ );
+}
+
+void NewReno::on_ack( uint64_t bytes_acked, uint64_t now_ms [[maybe_unused]] )
+{
+  if ( in_slow_start() ) {
+    slow_start( bytes_acked );
+    return;
+  }
+
+  // congestion avoidance: one more segment for each window's worth of acknowledged bytes
+  bytes_acked_ += bytes_acked;
+  if ( bytes_acked_ >= cwnd_ ) {
+    bytes_acked_ -= cwnd_;
+    cwnd_ += mss_;
+  }
+}
+
+void NewReno::on_loss( uint64_t bytes_in_flight, uint64_t now_ms [[maybe_unused]] )
+{
+  ssthresh_ = max( bytes_in_flight / 2, 2 * mss_ );
+  cwnd_ = ssthresh_;
+  bytes_acked_ = 0;
+}
+
+void NewReno::on_timeout( uint64_t bytes_in_flight, uint64_t now_ms [[maybe_unused]] )
+{
+  ssthresh_ = max( bytes_in_flight / 2, 2 * mss_ );
+  cwnd_ = mss_;
+  bytes_acked_ = 0;
+}
+
+double Cubic::cubic_window( double t_ms ) const
+{
+  const double t = t_ms / 1000 - k_;
+  return C * t * t * t + w_max_;
+}
+
+void Cubic::reduce()
+{
+  // fast convergence: if the window didn't get back to the last W_max, leave room for newer flows
+  const double cwnd = segments( cwnd_ );
+  w_max_ = cwnd < w_max_ ? cwnd * ( 1 + BETA ) / 2 : cwnd;
+  ssthresh_ = max( static_cast<uint64_t>( static_cast<double>( cwnd_ ) * BETA ), 2 * mss_ );
+  epoch_start_ms_.reset();
+  increment_ = 0;
+}
+
+void Cubic::on_ack( uint64_t bytes_acked, uint64_t now_ms )
+{
+  if ( in_slow_start() ) {
+    slow_start( bytes_acked );
+    return;
+  }
+
+  const double cwnd = segments( cwnd_ );
+
+  if ( !epoch_start_ms_.has_value() ) {
+    epoch_start_ms_ = now_ms;
+    k_ = cwnd < w_max_ ? cbrt( ( w_max_ - cwnd ) / C ) : 0;
+    w_max_ = max( w_max_, cwnd );
+    w_est_ = cwnd;
+  }
+
+  // Reno's growth, with the additive increase that gives it the same average rate as CUBIC's decrease
+  w_est_ += 3 * ( 1 - BETA ) / ( 1 + BETA ) * segments( bytes_acked ) / cwnd;
+
+  const double t_ms = static_cast<double>( now_ms - epoch_start_ms_.value() );
+  double next = w_est_;
+  if ( cubic_window( t_ms ) >= w_est_ ) {
+    // head for where the cubic function will be one RTT from now, but at most 1.5 times the window
+    const double rtt_ms = static_cast<double>( min_rtt_ms_.value_or( 0 ) );
+    const double target = clamp( cubic_window( t_ms + rtt_ms ), cwnd, 1.5 * cwnd );
+    next = cwnd + ( target - cwnd ) / cwnd * segments( bytes_acked );
+  }
+
+  increment_ += max( next - cwnd, 0.0 ) * static_cast<double>( mss_ );
+  const double whole_bytes = floor( increment_ );
+  cwnd_ += static_cast<uint64_t>( whole_bytes );
+  increment_ -= whole_bytes;
+}
+
+void Cubic::on_loss( uint64_t bytes_in_flight [[maybe_unused]], uint64_t now_ms [[maybe_unused]] )
+{
+  reduce();
+  cwnd_ = ssthresh_;
+}
+
+void Cubic::on_timeout( uint64_t bytes_in_flight [[maybe_unused]], uint64_t now_ms [[maybe_unused]] )
+{
+  reduce();
+  cwnd_ = mss_;
+}
+
+void Cubic::on_rtt_sample( uint64_t rtt_ms )
+{
+  min_rtt_ms_ = min( min_rtt_ms_.value_or( rtt_ms ), rtt_ms );
+}
+
+void Cubic::set_mss( uint64_t mss )
+{
+  // W_max and W_est are counted in segments: keep them as many bytes as before
+  const double ratio = static_cast<double>( mss_ ) / static_cast<double>( mss );
+  w_max_ *= ratio;
+  w_est_ *= ratio;
+  CongestionControl::set_mss( mss );
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+/*
+ * Congestion control for a TCPSender: limits the bytes in flight to a congestion window
+ * (cwnd) on top of the peer's advertised window.
+ *
+ * The sender reports what happens to its segments through the hooks; the algorithm adjusts
+ * cwnd and ssthresh (the slow-start threshold), both in bytes. Every algorithm starts in slow
+ * start with the initial window of RFC 5681 and an unbounded ssthresh.
+ */
+class CongestionControl
+{
+public:
+  enum class Algorithm
+  {
+    None,    // Send whatever the peer's window allows
+    NewReno, // RFC 5681 / RFC 6582
+    Cubic,   // RFC 9438
+  };
+
+  // An algorithm for segments of `mss` bytes (nullptr for Algorithm::None)
+  static std::unique_ptr<CongestionControl> make( Algorithm algorithm, uint64_t mss );
+
+  explicit CongestionControl( uint64_t mss );
+  virtual ~CongestionControl() = default;
+
+  CongestionControl( const CongestionControl& other ) = default;
+  CongestionControl& operator=( const CongestionControl& other ) = default;
+
+  // `bytes_acked` new bytes were cumulatively acknowledged, `now_ms` since the sender started
+  virtual void on_ack( uint64_t bytes_acked, uint64_t now_ms ) = 0;
+
+  // A loss was detected without a timeout (e.g. by duplicate ACKs) with `bytes_in_flight` outstanding
+  virtual void on_loss( uint64_t bytes_in_flight, uint64_t now_ms ) = 0;
+
+  // The retransmission timer expired with `bytes_in_flight` outstanding
+  virtual void on_timeout( uint64_t bytes_in_flight, uint64_t now_ms ) = 0;
+
+  // A round-trip time was measured
+  virtual void on_rtt_sample( uint64_t rtt_ms );
+
+  // Fast recovery (RFC 6582), following on_loss(): every duplicate ACK means a segment has left the
+  // network and inflates the window by that much, a partial ACK deflates it by the bytes it acknowledged,
+  // and once everything outstanding at the loss is acknowledged the window goes back to ssthresh
+  void inflate( uint64_t bytes ) { cwnd_ += bytes; }
+  void deflate( uint64_t bytes_acked );
+  void end_recovery() { cwnd_ = ssthresh_; }
+
+  // The sender's segment size changed (MSS option, path MTU discovery): the window keeps its size in bytes
+  // and grows in segments of the new size, unless nothing was acknowledged yet and it is still the initial one
+  virtual void set_mss( uint64_t mss );
+
+  uint64_t cwnd() const { return cwnd_; }
+  uint64_t ssthresh() const { return ssthresh_; }
+  uint64_t mss() const { return mss_; }
+  bool in_slow_start() const { return cwnd_ < ssthresh_; }
+
+protected:
+  uint64_t mss_;
+  uint64_t cwnd_;
+  uint64_t ssthresh_ { UINT64_MAX };
+
+  // Slow start (RFC 5681 3.1): grow by up to one segment per ACK
+  void slow_start( uint64_t bytes_acked );
+
+  static uint64_t initial_window( uint64_t mss );
+};
+
+/* NewReno (RFC 5681): halve the window on loss, then grow it by one segment per round trip. */
+class NewReno : public CongestionControl
+{
+  uint64_t bytes_acked_ {}; // Acknowledged in congestion avoidance, towards the next one-segment increase
+
+public:
+  using CongestionControl::CongestionControl;
+
+  void on_ack( uint64_t bytes_acked, uint64_t now_ms ) override;
+  void on_loss( uint64_t bytes_in_flight, uint64_t now_ms ) override;
+  void on_timeout( uint64_t bytes_in_flight, uint64_t now_ms ) override;
+};
+
+/*
+ * CUBIC (RFC 9438): after a loss, the window follows a cubic function of the time since then,
+ * flattening out around the window where the loss happened (W_max) before probing beyond it.
+ * It never grows slower than Reno would.
+ */
+class Cubic : public CongestionControl
+{
+  static constexpr double C = 0.4;
+  static constexpr double BETA = 0.7;
+
+  double w_max_ {};                           // Window before the last reduction, in segments
+  double k_ {};                               // Seconds it takes the cubic function to get back to W_max
+  double w_est_ {};                           // What Reno would have reached, in segments
+  double increment_ {};                       // Fraction of a byte of cwnd growth carried to the next ACK
+  std::optional<uint64_t> epoch_start_ms_ {}; // When the current congestion avoidance period started
+  std::optional<uint64_t> min_rtt_ms_ {};
+
+  double segments( uint64_t bytes ) const { return static_cast<double>( bytes ) / static_cast<double>( mss_ ); }
+  void reduce(); // Remember W_max and lower ssthresh after a congestion event
+
+public:
+  using CongestionControl::CongestionControl;
+
+  void on_ack( uint64_t bytes_acked, uint64_t now_ms ) override;
+  void on_loss( uint64_t bytes_in_flight, uint64_t now_ms ) override;
+  void on_timeout( uint64_t bytes_in_flight, uint64_t now_ms ) override;
+  void on_rtt_sample( uint64_t rtt_ms ) override;
+  void set_mss( uint64_t mss ) override;
+
+  // Window the cubic function gives `t_ms` into the current congestion avoidance period, in segments
+  double cubic_window( double t_ms ) const;
+};
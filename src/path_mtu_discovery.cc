@@ -0,0 +1,52 @@
+#include "path_mtu_discovery.hh"
+
+#include <algorithm>
+
+using namespace std;
+
+PathMTUDiscovery::PathMTUDiscovery( uint64_t base, uint64_t max )
+  : plpmtu_( min( base, max ) ), search_high_( max )
+{
+  next_size( search_high_ );
+}
+
+void PathMTUDiscovery::next_size( uint64_t size )
+{
+  probe_size_ = search_high_ - plpmtu_ >= SEARCH_GRANULARITY ? size : 0;
+  probe_count_ = 0;
+}
+
+void PathMTUDiscovery::limit( uint64_t max )
+{
+  plpmtu_ = min( plpmtu_, max );
+  search_high_ = min( search_high_, max );
+
+  if ( !probe_in_flight_ )
+    next_size( search_high_ );
+}
+
+optional<uint64_t> PathMTUDiscovery::probe_size() const
+{
+  if ( search_complete() || probe_in_flight_ )
+    return {};
+
+  return probe_size_;
+}
+
+void PathMTUDiscovery::on_probe_acked()
+{
+  probe_in_flight_ = false;
+  plpmtu_ = probe_size_;
+  next_size( plpmtu_ + ( search_high_ - plpmtu_ + 1 ) / 2 );
+}
+
+void PathMTUDiscovery::on_probe_lost()
+{
+  probe_in_flight_ = false;
+
+  if ( ++probe_count_ < MAX_PROBES )
+    return;
+
+  search_high_ = probe_size_ - 1;
+  next_size( plpmtu_ + ( search_high_ - plpmtu_ + 1 ) / 2 );
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+/*
+ * Packetization-layer path MTU discovery (RFC 8899, the way RFC 4821 applies it to TCP), in payload bytes
+ * per segment.
+ *
+ * The sender starts from a base size every path is assumed to carry and searches for the largest size
+ * up to a maximum (what the peer's MSS option allows). A probe is a segment of the size being tried,
+ * filled with stream data. An acknowledged probe confirms its size; a size is given up once MAX_PROBES
+ * probes of it were lost. The first probe tries the maximum, after which the search halves the range
+ * left until it is narrower than SEARCH_GRANULARITY. Probes are found lost by the sender's own loss
+ * detection, so nothing depends on ICMP Packet Too Big messages getting through.
+ */
+class PathMTUDiscovery
+{
+  uint64_t plpmtu_;      // Largest size confirmed to get through
+  uint64_t search_high_; // Largest size not known to be too large
+  uint64_t probe_size_ {};
+  unsigned probe_count_ {}; // Probes of probe_size_ lost so far
+  bool probe_in_flight_ {};
+
+  void next_size( uint64_t size ); // Probe `size` next, or end the search if it is not worth it
+
+public:
+  static constexpr unsigned MAX_PROBES = 3;          // RFC 8899 5.1.2
+  static constexpr uint64_t SEARCH_GRANULARITY = 8; // Bytes; a narrower range is not searched
+
+  PathMTUDiscovery( uint64_t base, uint64_t max );
+
+  // The peer accepts no more than `max` (its MSS option)
+  void limit( uint64_t max );
+
+  // Size of the next probe, unless the search is over or a probe is outstanding
+  std::optional<uint64_t> probe_size() const;
+
+  void on_probe_sent() { probe_in_flight_ = true; }
+  void on_probe_acked(); // Received: the path carries probe_size()
+  void on_probe_lost();
+
+  uint64_t plpmtu() const { return plpmtu_; }
+  bool search_complete() const { return probe_size_ == 0; }
+};
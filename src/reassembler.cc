@@ -1,91 +1,226 @@
 #include "reassembler.hh"
 
+#include <algorithm>
+#include <unordered_set>
+#include <utility>
+
 using namespace std;
 
-Reassembler::Reassembler() : m_buf() {}
+Reassembler::Reassembler() = default;
 
-void Reassembler::_write_to_stream( Writer& output )
+Reassembler::Reassembler( shared_ptr<ReassemblyBudget> budget ) : m_budget( std::move( budget ) ) {}
+
+Reassembler::Reassembler( const Reassembler& other )
+  : m_held( other.m_held )
+  , m_bytes_pending( other.m_bytes_pending )
+  , m_stream_end( other.m_stream_end )
+  , m_budget( other.m_budget )
+  , m_bytes_pruned( other.m_bytes_pruned )
+{
+  _charge( m_bytes_pending );
+}
+
+Reassembler::Reassembler( Reassembler&& other ) noexcept
+  : m_held( std::move( other.m_held ) )
+  , m_bytes_pending( exchange( other.m_bytes_pending, 0 ) )
+  , m_stream_end( other.m_stream_end )
+  , m_budget( std::move( other.m_budget ) )
+  , m_bytes_pruned( other.m_bytes_pruned )
+{}
+
+Reassembler& Reassembler::operator=( const Reassembler& other )
 {
-  auto iter = m_buf.begin();
+  if ( this != &other ) {
+    *this = Reassembler( other );
+  }
+  return *this;
+}
 
-  for ( ; iter != m_buf.end() && iter->first == output.bytes_pushed(); ++iter ) {
-    output.push( iter->second );
-    m_bytes_pending -= iter->second.size();
+Reassembler& Reassembler::operator=( Reassembler&& other ) noexcept
+{
+  if ( this != &other ) {
+    _release( m_bytes_pending );
+    m_held = std::move( other.m_held );
+    m_bytes_pending = exchange( other.m_bytes_pending, 0 );
+    m_stream_end = other.m_stream_end;
+    m_budget = std::move( other.m_budget );
+    m_bytes_pruned = other.m_bytes_pruned;
   }
+  return *this;
+}
 
-  m_buf.erase( m_buf.begin(), iter );
+Reassembler::~Reassembler()
+{
+  _release( m_bytes_pending );
 }
 
-void Reassembler::_delete_overlapping( uint64_t index )
+void Reassembler::_release( uint64_t len )
 {
-  auto begin = m_buf.find( index );
+  m_bytes_pending -= len;
 
-  if ( begin == m_buf.end() )
+  if ( m_budget )
+    m_budget->refund( len );
+}
+
+void Reassembler::_charge( uint64_t len )
+{
+  if ( !m_budget )
     return;
 
-  uint64_t end_index = begin->second.size() + begin->first;
-  auto end = ++begin;
+  uint64_t granted = m_budget->charge( len );
 
-  for ( ; end != m_buf.end() && end->first + end->second.size() <= end_index; ++end )
-    m_bytes_pending -= end->second.size();
+  if ( granted < len )
+    _prune( len - granted );
+}
 
-  m_buf.erase( begin, end );
+void Reassembler::_prune( uint64_t len )
+{
+  m_bytes_pending -= len;
+  m_bytes_pruned += len;
+  m_budget->record_pruned( len );
+
+  // drop from the highest offsets down
+  while ( len > 0 ) {
+    auto last = m_held.extract( prev( m_held.end() ) );
+    uint64_t drop = min( len, last.mapped().length );
+    last.mapped().length -= drop;
+    len -= drop;
+
+    if ( last.mapped().length > 0 ) {
+      last.mapped().compact();
+      last.key() = last.mapped().end();
+      m_held.insert( m_held.end(), std::move( last ) );
+    }
+  }
 }
 
-void Reassembler::_insert_to_buffer( uint64_t accept_begin, uint64_t len, uint64_t first_index, string& data )
+void Reassembler::Slice::remove_prefix( uint64_t len )
 {
-  uint64_t accept_end = accept_begin + len;
+  begin += len;
+  offset += len;
+  length -= len;
+  compact();
+}
 
-  if ( first_index >= accept_end )
+// A slice holding less than half of its payload gets a copy of its own bytes instead, so that a small slice
+// never pins a large payload and the memory held stays within twice what is charged to the budget
+void Reassembler::Slice::compact()
+{
+  if ( length == 0 || 2 * length >= buffer.size() )
     return;
 
-  decltype( m_buf )::iterator iter;
+  buffer = Buffer( string( view() ) );
+  offset = 0;
+}
+
+void Reassembler::_copy_to_stream( string_view data, Writer& output )
+{
+  auto regions = output.reserve( data.size() );
+  data.copy( regions[0].data(), regions[0].size() );
+  data.substr( regions[0].size() ).copy( regions[1].data(), regions[1].size() );
+  output.commit( regions[0].size() + regions[1].size() );
+}
+
+void Reassembler::_write_to_stream( Writer& output )
+{
+  auto iter = m_held.begin();
+
+  for ( ; iter != m_held.end() && iter->second.begin == output.bytes_pushed(); ++iter ) {
+    Slice& slice = iter->second;
+    uint64_t len = min( slice.length, output.available_capacity() );
+
+    if ( len == 0 )
+      break;
 
-  // Clamp end of data
-  uint64_t end_index = first_index + data.size();
-  uint64_t clamped_end = accept_end < end_index ? accept_end : end_index;
-  iter = m_buf.lower_bound( end_index );
+    // a slice that is the whole, unshared payload is moved into the stream
+    if ( slice.offset == 0 && len == slice.buffer.size() && slice.buffer.unique() )
+      output.push( slice.buffer.release() );
+    else
+      _copy_to_stream( slice.view().substr( 0, len ), output );
 
-  if ( iter != m_buf.begin() ) {
-    --iter;
-    uint_fast64_t next_end = iter->first + iter->second.size();
-    clamped_end = next_end >= end_index ? iter->first : end_index;
+    _release( len );
+    slice.remove_prefix( len );
+
+    if ( slice.length > 0 )
+      break;
   }
 
-  // Clamp begin of data
-  uint64_t clamped_begin = accept_begin > first_index ? accept_begin : first_index;
-  iter = m_buf.upper_bound( first_index );
+  m_held.erase( m_held.begin(), iter );
+}
+
+void Reassembler::_discard_below( uint64_t index )
+{
+  auto iter = m_held.begin();
 
-  if ( iter != m_buf.begin() )
-    --iter;
+  for ( ; iter != m_held.end() && iter->first <= index; ++iter )
+    _release( iter->second.length );
 
-  if ( iter->first + iter->second.size() > clamped_begin ) {
-    for ( ; iter != m_buf.end() && iter->first <= clamped_begin; ++iter )
-      clamped_begin = iter->first + iter->second.size();
+  if ( iter != m_held.end() && iter->second.begin < index ) {
+    _release( index - iter->second.begin );
+    iter->second.remove_prefix( index - iter->second.begin );
   }
 
-  // return if no bytes need to store
-  if ( clamped_begin >= clamped_end )
-    return;
+  m_held.erase( m_held.begin(), iter );
+}
+
+void Reassembler::_push_in_order( uint64_t first_index, Buffer& data, Writer& output )
+{
+  if ( first_index == output.bytes_pushed() && data.unique() ) {
+    // hand the payload over as-is
+    output.push( data.release() );
+  } else {
+    // part of it was already written (or someone else shares it): copy only the new bytes
+    _copy_to_stream( string_view( data ).substr( output.bytes_pushed() - first_index ), output );
+  }
+
+  // only held bytes that the payload overlapped need attention
+  _discard_below( output.bytes_pushed() );
+}
+
+void Reassembler::_insert_to_buffer( uint64_t accept_begin, uint64_t len, uint64_t first_index, const Buffer& data )
+{
+  uint64_t begin = max( accept_begin, first_index );
+  uint64_t end = min( accept_begin + len, first_index + data.size() );
+
+  // hold a slice of `data` for every gap in [begin, end)
+  uint64_t added = 0;
+  auto iter = m_held.upper_bound( begin ); // first slice ending after `begin`
 
-  // Clamp the data
-  data.erase( data.begin() + clamped_end - first_index, data.end() );
-  data.erase( data.begin(), data.begin() + clamped_begin - first_index );
+  while ( begin < end ) {
+    if ( iter != m_held.end() && iter->second.begin <= begin ) {
+      begin = iter->first;
+      ++iter;
+      continue;
+    }
 
-  // add to buffer
-  m_bytes_pending += data.size();
-  m_buf[clamped_begin] = std::move( data );
+    uint64_t gap_end = iter == m_held.end() ? end : min( end, iter->second.begin );
+    Slice slice { begin, data, begin - first_index, gap_end - begin };
+    slice.compact();
+    m_held.emplace_hint( iter, gap_end, std::move( slice ) );
+    added += gap_end - begin;
+    begin = gap_end;
+  }
 
-  _delete_overlapping( clamped_begin );
+  m_bytes_pending += added;
+  _charge( added );
 }
 
 void Reassembler::insert( uint64_t first_index, string data, bool is_last_substring, Writer& output )
+{
+  insert( first_index, Buffer( std::move( data ) ), is_last_substring, output );
+}
+
+void Reassembler::insert( uint64_t first_index, Buffer data, bool is_last_substring, Writer& output )
 {
   // update last index
   if ( is_last_substring )
     m_stream_end = first_index + data.size();
 
-  _insert_to_buffer( output.bytes_pushed(), output.available_capacity(), first_index, data );
+  if ( first_index <= output.bytes_pushed() && output.bytes_pushed() < first_index + data.size() )
+    _push_in_order( first_index, data, output );
+  else
+    _insert_to_buffer( output.bytes_pushed(), output.available_capacity(), first_index, data );
+
   _write_to_stream( output );
 
   // try to close stream
@@ -97,3 +232,32 @@ uint64_t Reassembler::bytes_pending() const
 {
   return m_bytes_pending;
 }
+
+uint64_t Reassembler::bytes_retained() const
+{
+  unordered_set<const char*> payloads;
+  uint64_t retained = 0;
+
+  for ( const auto& [end, slice] : m_held ) {
+    const string_view payload = slice.buffer;
+    if ( payloads.insert( payload.data() ).second )
+      retained += payload.size();
+  }
+
+  return retained;
+}
+
+vector<Reassembler::Interval> Reassembler::held_intervals() const
+{
+  vector<Interval> intervals;
+
+  // adjacent slices (e.g. from different payloads) form one run
+  for ( const auto& [end, slice] : m_held ) {
+    if ( !intervals.empty() && intervals.back().end == slice.begin )
+      intervals.back().end = slice.end();
+    else
+      intervals.push_back( { slice.begin, slice.end() } );
+  }
+
+  return intervals;
+}
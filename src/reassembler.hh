@@ -1,22 +1,53 @@
 #pragma once
 
+#include "buffer.hh"
 #include "byte_stream.hh"
+#include "reassembly_budget.hh"
 
+#include <cstdint>
 #include <map>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
 
 class Reassembler
 {
 private:
+  // Held bytes [begin, begin + length), referencing `length` bytes of `buffer` starting at `offset`
+  struct Slice
+  {
+    uint64_t begin;
+    Buffer buffer;
+    uint64_t offset;
+    uint64_t length;
+
+    uint64_t end() const { return begin + length; }
+    std::string_view view() const { return std::string_view( buffer ).substr( offset, length ); }
+    void remove_prefix( uint64_t len );
+    void compact();
+  };
+
   void _write_to_stream( Writer& output );
-  void _insert_to_buffer( uint64_t accept_begin, uint64_t len, uint64_t first_index, std::string& data );
-  void _delete_overlapping( uint64_t index );
+  void _insert_to_buffer( uint64_t accept_begin, uint64_t len, uint64_t first_index, const Buffer& data );
+  void _push_in_order( uint64_t first_index, Buffer& data, Writer& output );
+  void _discard_below( uint64_t index );
+  void _release( uint64_t len );
+  void _charge( uint64_t len );
+  void _prune( uint64_t len );
+  static void _copy_to_stream( std::string_view data, Writer& output );
 
 protected:
-  std::map<uint64_t, std::string> m_buf;
+  // Held data refers to the inserted payloads instead of copying them; trimming only adjusts a slice.
+  // Keyed by end index, which stays put when a slice loses its prefix.
+  std::map<uint64_t, Slice> m_held {}; // Disjoint
   uint64_t m_bytes_pending = 0;
   uint64_t m_stream_end = UINT64_MAX;
 
+  // Shared cap on held bytes (none if empty), and how much this Reassembler dropped to stay under it
+  std::shared_ptr<ReassemblyBudget> m_budget {};
+  uint64_t m_bytes_pruned = 0;
+
 public:
   /*
    * Insert a new substring to be reassembled into a ByteStream.
@@ -40,8 +71,37 @@ public:
    */
   Reassembler();
 
+  // Charge every held byte against `budget`, which may be shared with other Reassemblers
+  explicit Reassembler( std::shared_ptr<ReassemblyBudget> budget );
+
+  // Held bytes stay charged to the budget until they leave the Reassembler
+  Reassembler( const Reassembler& other );
+  Reassembler( Reassembler&& other ) noexcept;
+  Reassembler& operator=( const Reassembler& other );
+  Reassembler& operator=( Reassembler&& other ) noexcept;
+  ~Reassembler();
+
+  // A run of bytes [begin, end), in stream indices
+  struct Interval
+  {
+    uint64_t begin;
+    uint64_t end;
+  };
+
   void insert( uint64_t first_index, std::string data, bool is_last_substring, Writer& output );
 
+  // Same, but holds on to the Buffer itself; when nothing else references it, it is moved into the stream
+  void insert( uint64_t first_index, Buffer data, bool is_last_substring, Writer& output );
+
   // How many bytes are stored in the Reassembler itself?
   uint64_t bytes_pending() const;
+
+  // How many held bytes were dropped because the shared budget ran out?
+  uint64_t bytes_pruned() const { return m_bytes_pruned; }
+
+  // How many bytes do the held slices keep allocated (each payload they refer to counted once)?
+  uint64_t bytes_retained() const;
+
+  // Which bytes are stored, as maximal runs in increasing order?
+  std::vector<Interval> held_intervals() const;
 };
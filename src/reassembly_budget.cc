@@ -0,0 +1,37 @@
+#include "reassembly_budget.hh"
+
+#include <algorithm>
+
+using namespace std;
+
+uint64_t ReassemblyBudget::charge( uint64_t len )
+{
+  uint64_t held = bytes_held_.load( memory_order_relaxed );
+  uint64_t granted = 0;
+
+  do {
+    granted = min( len, capacity_ - min( held, capacity_ ) );
+  } while ( granted > 0 && !bytes_held_.compare_exchange_weak( held, held + granted, memory_order_relaxed ) );
+
+  return granted;
+}
+
+void ReassemblyBudget::refund( uint64_t len )
+{
+  bytes_held_.fetch_sub( len, memory_order_relaxed );
+}
+
+void ReassemblyBudget::record_pruned( uint64_t len )
+{
+  bytes_pruned_.fetch_add( len, memory_order_relaxed );
+}
+
+uint64_t ReassemblyBudget::bytes_held() const
+{
+  return bytes_held_.load( memory_order_relaxed );
+}
+
+uint64_t ReassemblyBudget::bytes_pruned() const
+{
+  return bytes_pruned_.load( memory_order_relaxed );
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/*
+ * A cap on the out-of-order bytes held by every Reassembler that shares this object.
+ *
+ * Reassemblers charge the budget for each byte they hold and refund it when the byte is
+ * written to the stream or discarded. When the budget runs out, a Reassembler gives up its
+ * highest-offset bytes first (they are the furthest from being useful, and the sender will
+ * retransmit them) and records them as pruned. A Reassembler copies out a slice too small to justify
+ * keeping its whole payload alive, so the memory held stays within twice the bytes charged. Safe to share
+ * between threads.
+ */
+class ReassemblyBudget
+{
+  uint64_t capacity_;
+  std::atomic<uint64_t> bytes_held_ { 0 };
+  std::atomic<uint64_t> bytes_pruned_ { 0 };
+
+public:
+  explicit ReassemblyBudget( uint64_t capacity ) : capacity_( capacity ) {}
+
+  // Charge up to `len` bytes; returns how many were granted
+  uint64_t charge( uint64_t len );
+
+  // Give back `len` previously charged bytes
+  void refund( uint64_t len );
+
+  // Note that `len` bytes were dropped for lack of budget
+  void record_pruned( uint64_t len );
+
+  uint64_t capacity() const { return capacity_; }
+  uint64_t bytes_held() const;   // Bytes currently charged, across all Reassemblers
+  uint64_t bytes_pruned() const; // Total bytes dropped so far because the budget was exhausted
+};
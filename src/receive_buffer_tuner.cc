@@ -0,0 +1,48 @@
+#include "receive_buffer_tuner.hh"
+
+#include <algorithm>
+
+using namespace std;
+
+ReceiveBufferTuner::ReceiveBufferTuner( uint64_t min_capacity, uint64_t max_capacity )
+  : min_capacity_( min_capacity ), max_capacity_( max( min_capacity, max_capacity ) )
+{}
+
+void ReceiveBufferTuner::on_receive( const ByteStream& inbound )
+{
+  const uint64_t pushed = inbound.writer().bytes_pushed();
+
+  if ( rtt_seq_.has_value() && pushed >= rtt_seq_.value() ) {
+    // a sample is an upper bound on the RTT (the sender may not have sent at once), so trust smaller ones more
+    const uint64_t sample = max<uint64_t>( now_ms_ - rtt_start_ms_, 1 );
+    rtt_ms_ = !rtt_ms_.has_value() || sample < rtt_ms_.value() ? sample : ( 7 * rtt_ms_.value() + sample ) / 8;
+    rtt_seq_.reset();
+  }
+
+  if ( !rtt_seq_.has_value() ) {
+    rtt_seq_ = pushed + inbound.writer().available_capacity();
+    rtt_start_ms_ = now_ms_;
+  }
+}
+
+void ReceiveBufferTuner::tick( uint64_t ms_since_last_tick, const ByteStream& inbound )
+{
+  now_ms_ += ms_since_last_tick;
+
+  if ( !rtt_ms_.has_value() || now_ms_ - epoch_start_ms_ < rtt_ms_.value() )
+    return;
+
+  const uint64_t popped = inbound.reader().bytes_popped();
+  target_capacity_ = clamp( 2 * ( popped - epoch_popped_ ), min_capacity_, max_capacity_ );
+  epoch_start_ms_ = now_ms_;
+  epoch_popped_ = popped;
+}
+
+void ReceiveBufferTuner::resize( ByteStream& inbound, uint64_t advertised_edge ) const
+{
+  if ( !target_capacity_.has_value() || inbound.writer().is_closed() )
+    return;
+
+  const uint64_t popped = inbound.reader().bytes_popped();
+  inbound.set_capacity( max( target_capacity_.value(), advertised_edge - min( advertised_edge, popped ) ) );
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "byte_stream.hh"
+
+#include <cstdint>
+#include <optional>
+
+/*
+ * Receive-buffer autotuning, in the spirit of Linux "dynamic right-sizing".
+ *
+ * The receiver estimates the round-trip time as how long it takes a full window of data to
+ * arrive after it was opened. Once per such RTT, it aims for a buffer of twice what the
+ * application read during that RTT (so a window-limited sender can double its rate), within
+ * [min_capacity, max_capacity]. A shrinking buffer never takes back window that was already
+ * advertised: it gives up the space the application reads instead of advertising it again.
+ */
+class ReceiveBufferTuner
+{
+  uint64_t min_capacity_;
+  uint64_t max_capacity_;
+  std::optional<uint64_t> target_capacity_ {};
+
+  uint64_t now_ms_ {};
+  std::optional<uint64_t> rtt_ms_ {}; // Smoothed receiver-side RTT estimate
+
+  // Measurement in progress: started at `rtt_start_ms_`, done when the stream has been pushed up to `rtt_seq_`
+  std::optional<uint64_t> rtt_seq_ {};
+  uint64_t rtt_start_ms_ {};
+
+  uint64_t epoch_start_ms_ {}; // When the current RTT-long measurement of the read rate started
+  uint64_t epoch_popped_ {};   // bytes_popped() at that time
+
+public:
+  ReceiveBufferTuner( uint64_t min_capacity, uint64_t max_capacity );
+
+  // Data arrived on the inbound stream
+  void on_receive( const ByteStream& inbound );
+
+  // Time has passed; pick a new target capacity if another RTT has gone by
+  void tick( uint64_t ms_since_last_tick, const ByteStream& inbound );
+
+  // Bring the inbound stream to the target capacity, as far as it can go without taking back the window
+  // up to stream index `advertised_edge`. Call before advertising a window.
+  void resize( ByteStream& inbound, uint64_t advertised_edge ) const;
+
+  std::optional<uint64_t> rtt_ms() const { return rtt_ms_; }
+  std::optional<uint64_t> target_capacity() const { return target_capacity_; }
+};
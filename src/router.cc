@@ -32,7 +32,7 @@ bool Router::RouteTable::look_up( const uint32_t ipv4_address, size_t& interface
   size_t num = 0;
   bool matched = false;
 
-  for ( const auto pair : entries ) {
+  for ( const auto& pair : entries ) {
     if ( match( ipv4_address, pair.first ) && ( pair.first & prefix_length_mask ) >= longest_prefix_length ) {
       matched = true;
 
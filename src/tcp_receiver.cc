@@ -1,5 +1,7 @@
 #include "tcp_receiver.hh"
 
+#include <algorithm>
+
 using namespace std;
 
 void TCPReceiver::receive( TCPSenderMessage message, Reassembler& reassembler, Writer& inbound_stream )
@@ -13,6 +15,10 @@ void TCPReceiver::receive( TCPSenderMessage message, Reassembler& reassembler, W
   m_recv_zero_point = message.SYN ? message.seqno : m_recv_zero_point;
 
   uint64_t first_index = message.seqno.unwrap( m_recv_zero_point, inbound_stream.bytes_pushed() ) - 1 + message.SYN;
+
+  if ( !message.payload.empty() )
+    m_last_index = first_index;
+
   reassembler.insert( first_index, std::move( message.payload ), message.FIN, inbound_stream );
 }
 
@@ -26,7 +32,33 @@ TCPReceiverMessage TCPReceiver::send( const Writer& inbound_stream ) const
     message.ackno = Wrap32::wrap( absolute_ackno, m_recv_zero_point );
   }
 
-  message.window_size = inbound_stream.available_capacity() > 0xFFFF ? 0xFFFF : inbound_stream.available_capacity();
+  uint64_t scaled_window = inbound_stream.available_capacity() >> m_window_scale;
+  message.window_size = scaled_window > 0xFFFF ? 0xFFFF : scaled_window;
 
   return message;
 }
+
+vector<SACKBlock> TCPReceiver::sack_blocks( const Reassembler& reassembler ) const
+{
+  vector<SACKBlock> blocks;
+
+  if ( !m_syn_rcvd )
+    return blocks;
+
+  auto intervals = reassembler.held_intervals();
+  auto latest = find_if( intervals.begin(), intervals.end(), [this]( const Reassembler::Interval& interval ) {
+    return interval.begin <= m_last_index && m_last_index < interval.end;
+  } );
+
+  if ( latest != intervals.end() )
+    rotate( intervals.begin(), latest, next( latest ) );
+
+  // stream index i is sequence number i + 1, after the SYN
+  for ( const auto& [begin, end] : intervals ) {
+    if ( blocks.size() == TCPReceiverMessage::MAX_SACK_BLOCKS )
+      break;
+    blocks.push_back( { Wrap32::wrap( begin + 1, m_recv_zero_point ), Wrap32::wrap( end + 1, m_recv_zero_point ) } );
+  }
+
+  return blocks;
+}
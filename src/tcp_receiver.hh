@@ -14,6 +14,12 @@ protected:
   bool m_syn_rcvd { false };
   bool m_fin_rcvd { false };
 
+  // stream index of the most recently received payload, reported first among the SACK blocks
+  uint64_t m_last_index { 0 };
+
+  // window scale shift (RFC 7323) applied to the advertised window, 0 until negotiated
+  uint8_t m_window_scale { 0 };
+
 public:
   /*
    * The TCPReceiver receives TCPSenderMessages, inserting their payload into the Reassembler
@@ -23,4 +29,13 @@ public:
 
   /* The TCPReceiver sends TCPReceiverMessages back to the TCPSender. */
   TCPReceiverMessage send( const Writer& inbound_stream ) const;
+
+  /* Advertise the window in units of 2^shift from now on (once window scaling has been negotiated). */
+  void set_window_scale( uint8_t shift ) { m_window_scale = shift; }
+
+  /*
+   * SACK blocks for the data held in the Reassembler (RFC 2018): the block containing the most recently
+   * received payload comes first, then the others in increasing order, up to MAX_SACK_BLOCKS.
+   */
+  std::vector<SACKBlock> sack_blocks( const Reassembler& reassembler ) const;
 };
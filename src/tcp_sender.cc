@@ -1,7 +1,9 @@
 #include "tcp_sender.hh"
 #include "tcp_config.hh"
 
+#include <algorithm>
 #include <random>
+#include <ranges>
 
 using namespace std;
 
@@ -28,15 +30,48 @@ RetransmissionTimeout::RetransmissionTimeout( uint64_t initial_RTO_ms )
   : m_value( initial_RTO_ms ), m_init_value( initial_RTO_ms )
 {}
 
+RetransmissionTimeout::RetransmissionTimeout( uint64_t initial_RTO_ms, uint64_t min_RTO_ms, uint64_t max_RTO_ms )
+  : m_value( initial_RTO_ms )
+  , m_init_value( initial_RTO_ms )
+  , m_estimate( true )
+  , m_min( min_RTO_ms )
+  , m_max( max( min_RTO_ms, max_RTO_ms ) )
+{}
+
+uint64_t RetransmissionTimeout::estimate() const
+{
+  // RTO = SRTT + max( G, 4 * RTTVAR ), with a clock granularity G of 1 ms
+  return clamp( m_srtt.value() + max<uint64_t>( 1, 4 * m_rttvar ), m_min, m_max );
+}
+
+void RetransmissionTimeout::add_sample( uint64_t rtt_ms )
+{
+  if ( !m_estimate )
+    return;
+
+  if ( !m_srtt.has_value() ) {
+    m_srtt = rtt_ms;
+    m_rttvar = rtt_ms / 2;
+  } else {
+    const uint64_t error = m_srtt.value() > rtt_ms ? m_srtt.value() - rtt_ms : rtt_ms - m_srtt.value();
+    m_rttvar = ( 3 * m_rttvar + error ) / 4;
+    m_srtt = ( 7 * m_srtt.value() + rtt_ms ) / 8;
+  }
+
+  m_value = estimate();
+}
+
 void RetransmissionTimeout::set_timeout( RestransmissionEvent event )
 {
   switch ( event ) {
     case TIMEOUT:
-      m_value += m_value;
+      m_value = m_estimate ? min( m_value + m_value, m_max ) : m_value + m_value;
       break;
 
     case SUCCESSFUL_RECEIPT:
-      m_value = m_init_value;
+      // when estimating, only a valid RTT sample (add_sample) ends the back-off (Karn's algorithm)
+      if ( !m_estimate )
+        m_value = m_init_value;
       break;
 
     default:
@@ -45,29 +80,254 @@ void RetransmissionTimeout::set_timeout( RestransmissionEvent event )
 }
 
 /* TCPSender constructor (uses a random ISN if none given) */
-TCPSender::TCPSender( uint64_t initial_RTO_ms, optional<Wrap32> fixed_isn )
-  : m_isn_( fixed_isn.value_or( Wrap32 { random_device()() } ) ), m_RTO_ms_( initial_RTO_ms )
+TCPSender::TCPSender( uint64_t initial_RTO_ms,
+                      optional<Wrap32> fixed_isn,
+                      unique_ptr<CongestionControl> congestion_control )
+  : m_isn_( fixed_isn.value_or( Wrap32 { random_device()() } ) )
+  , m_RTO_ms_( initial_RTO_ms )
+  , m_max_segment_size( congestion_control ? congestion_control->mss() : TCPConfig::MAX_PAYLOAD_SIZE )
+  , m_segment_size( m_max_segment_size )
+  , m_congestion_control_( std::move( congestion_control ) )
 {}
 
-uint64_t TCPSender::get_absolute_seqno() const
+TCPSender::TCPSender( const TCPConfig& cfg )
+  : TCPSender( cfg.rt_timeout, cfg.fixed_isn, CongestionControl::make( cfg.congestion_control, cfg.mss ) )
 {
-  return m_outstanding_messages_.empty()
-           ? m_window_left
-           : m_outstanding_messages_.rbegin()->first + m_outstanding_messages_.rbegin()->second.sequence_length();
+  if ( cfg.rtt_estimation )
+    m_RTO_ms_ = RetransmissionTimeout( cfg.rt_timeout, cfg.rto_min, cfg.rto_max );
+
+  m_fast_retransmit = cfg.fast_retransmit;
+  m_nagle = cfg.nagle;
+
+  m_max_segment_size = cfg.mss;
+  if ( cfg.plpmtud )
+    m_path_mtu.emplace( TCPConfig::MAX_PAYLOAD_SIZE, cfg.mss );
+
+  update_segment_size();
 }
 
-void TCPSender::push_message( std::string payload, bool syn, bool fin )
+void TCPSender::update_segment_size()
 {
-  uint64_t absolute_seqno = get_absolute_seqno();
+  // the options a segment carries count against the MSS, and what the path carries, too (RFC 9293 3.7.1)
+  const uint64_t size = m_path_mtu ? m_path_mtu->plpmtu() : m_max_segment_size;
+  m_segment_size = size > m_option_room ? size - m_option_room : 1;
 
-  TCPSenderMessage message;
-  message.seqno = Wrap32::wrap( absolute_seqno, m_isn_ );
-  message.payload = Buffer( std::move( payload ) );
-  message.SYN = syn;
-  message.FIN = fin;
+  if ( m_congestion_control_ )
+    m_congestion_control_->set_mss( m_segment_size );
+}
+
+void TCPSender::use_sack()
+{
+  m_sack = true;
+
+  // once SACK is in use, any segment may carry SACK blocks
+  m_option_room = TCPReceiverMessage::SACK_OPTION_LENGTH;
+  update_segment_size();
+}
+
+void TCPSender::set_peer_mss( uint64_t mss )
+{
+  m_max_segment_size = min( m_max_segment_size, mss );
+
+  if ( m_path_mtu )
+    m_path_mtu->limit( m_max_segment_size );
+
+  update_segment_size();
+}
+
+void TCPSender::uncork( const Reader& outbound_stream )
+{
+  m_corked = false;
+  m_push_seqno = outbound_stream.writer().bytes_pushed() + 1; // the SYN comes first
+}
+
+bool TCPSender::hold_tail( const Reader& outbound_stream, uint64_t len ) const
+{
+  // only a segment cut short by the data written so far waits, never one the windows limit, nor the FIN
+  if ( outbound_stream.bytes_buffered() >= len || outbound_stream.writer().is_closed()
+       || get_absolute_seqno() < m_push_seqno )
+    return false;
+
+  return m_corked || ( m_nagle && sequence_numbers_in_flight() > 0 );
+}
+
+optional<uint64_t> TCPSender::next_probe( const Reader& outbound_stream, uint64_t window_right ) const
+{
+  if ( !m_path_mtu || m_in_recovery )
+    return {};
+
+  // a probe is a full segment of the size tried, so only once there is that much to send (RFC 4821 7.3); its
+  // payload alone fills the size, so the path is known to carry the same size of payload and options
+  const optional<uint64_t> size = m_path_mtu->probe_size();
+  if ( !size.has_value() || get_absolute_seqno() + size.value() > window_right
+       || outbound_stream.bytes_buffered() < size.value() )
+    return {};
+
+  return size;
+}
+
+void TCPSender::probe_received( OutstandingMessage& outstanding )
+{
+  outstanding.probe = false;
+  m_path_mtu->on_probe_acked();
+  update_segment_size();
+}
+
+size_t TCPSender::split_probe( size_t i )
+{
+  const OutstandingMessage probe = m_outstanding_[i]; // keeps the payload alive while it is replaced
+  const string_view data = probe.message.payload;
+  size_t pieces = 0;
+
+  for ( uint64_t offset = 0; offset < data.size(); offset += m_segment_size, ++pieces ) {
+    OutstandingMessage piece { .seqno = probe.seqno + offset,
+                               .message = { .seqno = Wrap32::wrap( probe.seqno + offset, m_isn_ ),
+                                            .payload = Buffer( string( data.substr( offset, m_segment_size ) ) ),
+                                            .FIN = probe.message.FIN && offset + m_segment_size >= data.size() },
+                               .sent_ms = probe.sent_ms,
+                               .lost = probe.lost };
+
+    if ( pieces == 0 )
+      m_outstanding_[i] = std::move( piece );
+    else
+      m_outstanding_.insert( i + pieces, std::move( piece ) );
+  }
+
+  return pieces;
+}
+
+size_t TCPSender::find_outstanding( uint64_t seqno ) const
+{
+  return *ranges::partition_point( views::iota( size_t { 0 }, m_outstanding_.size() ),
+                                   [&]( size_t i ) { return m_outstanding_[i].seqno < seqno; } );
+}
+
+size_t TCPSender::resend( size_t i )
+{
+  // a lost probe says the path may not carry its size: its data goes again in segments that do
+  size_t count = 1;
+  if ( m_outstanding_[i].probe ) {
+    m_path_mtu->on_probe_lost();
+    count = split_probe( i );
+  }
+
+  for ( size_t j = i; j < i + count; ++j ) {
+    m_outstanding_[j].retransmitted = true;
+    m_outstanding_[j].resent = true;
+    m_resend_queue_.push( m_outstanding_[j].seqno );
+  }
+
+  return count;
+}
+
+void TCPSender::retransmit_earliest()
+{
+  resend( 0 );
+}
+
+bool TCPSender::update_scoreboard( const vector<SACKBlock>& blocks )
+{
+  bool newly_sacked = false;
+
+  // only whole segments count as SACKed
+  for ( const auto& block : blocks ) {
+    const uint64_t left = block.left.unwrap( m_isn_, m_window_left );
+    const uint64_t right = block.right.unwrap( m_isn_, m_window_left );
+
+    for ( size_t i = find_outstanding( left ); i < m_outstanding_.size(); ++i ) {
+      OutstandingMessage& outstanding = m_outstanding_[i];
+      if ( outstanding.seqno + outstanding.message.sequence_length() > right )
+        break;
+
+      newly_sacked = newly_sacked || !outstanding.sacked;
+      outstanding.sacked = true;
+      outstanding.lost = false;
+
+      if ( outstanding.probe )
+        probe_received( outstanding );
+    }
+  }
+
+  return newly_sacked;
+}
+
+void TCPSender::mark_lost()
+{
+  // IsLost(): DupThresh SACKed segments, or more than (DupThresh - 1) * SMSS SACKed bytes, above it
+  uint64_t sacked_segments = 0;
+  uint64_t sacked_bytes = 0;
+
+  for ( size_t i = m_outstanding_.size(); i-- > 0; ) {
+    OutstandingMessage& outstanding = m_outstanding_[i];
+
+    if ( outstanding.sacked ) {
+      sacked_segments++;
+      sacked_bytes += outstanding.message.sequence_length();
+    } else if ( !outstanding.lost
+                && ( sacked_segments >= TCPConfig::DUPACK_THRESHOLD
+                     || sacked_bytes > ( TCPConfig::DUPACK_THRESHOLD - 1 ) * m_segment_size ) ) {
+      outstanding.lost = true;
+      m_holes_pending = true;
+    }
+  }
+}
+
+uint64_t TCPSender::pipe() const
+{
+  uint64_t in_network = 0;
+
+  for ( size_t i = 0; i < m_outstanding_.size(); ++i ) {
+    const OutstandingMessage& outstanding = m_outstanding_[i];
+    if ( outstanding.sacked )
+      continue;
+
+    const uint64_t length = outstanding.message.sequence_length();
+    in_network += ( outstanding.lost ? 0 : length ) + ( outstanding.resent ? length : 0 );
+  }
+
+  return in_network;
+}
+
+void TCPSender::retransmit_holes()
+{
+  if ( !m_holes_pending )
+    return;
 
-  m_outstanding_messages_.insert( std::make_pair( absolute_seqno, message ) );
-  m_send_queue_.push( std::move( message ) );
+  // resend the lost segments in order while the congestion window has a segment's room beyond the pipe;
+  // without congestion control, all of them at once
+  const uint64_t cwnd = m_congestion_control_ ? m_congestion_control_->cwnd() : UINT64_MAX;
+  uint64_t in_network = pipe();
+
+  for ( size_t i = 0; i < m_outstanding_.size(); ++i ) {
+    OutstandingMessage& outstanding = m_outstanding_[i];
+    if ( !outstanding.lost || outstanding.resent )
+      continue;
+
+    if ( in_network >= cwnd || cwnd - in_network < min( cwnd, m_segment_size ) )
+      return;
+
+    in_network += outstanding.message.sequence_length();
+    i += resend( i ) - 1;
+  }
+
+  m_holes_pending = false;
+}
+
+void TCPSender::push_message( std::string payload, bool syn, bool fin, bool probe )
+{
+  TCPSenderMessage message { .seqno = Wrap32::wrap( m_next_seqno, m_isn_ ),
+                             .SYN = syn,
+                             .payload = Buffer( std::move( payload ) ),
+                             .FIN = fin };
+  const uint64_t seqno = m_next_seqno;
+
+  m_next_seqno += message.sequence_length();
+  m_outstanding_.push_back(
+    { .seqno = seqno, .message = std::move( message ), .sent_ms = m_timer_, .probe = probe } );
+  m_unsent++;
+
+  if ( probe )
+    m_path_mtu->on_probe_sent();
 }
 
 uint64_t TCPSender::sequence_numbers_in_flight() const
@@ -82,13 +342,29 @@ uint64_t TCPSender::consecutive_retransmissions() const
 
 optional<TCPSenderMessage> TCPSender::maybe_send()
 {
-  if ( m_send_queue_.empty() )
-    return {};
+  optional<TCPSenderMessage> message;
+
+  // retransmissions first, then the segments pushed since the last call
+  while ( !message.has_value() && !m_resend_queue_.empty() ) {
+    const uint64_t seqno = m_resend_queue_.front();
+    m_resend_queue_.pop();
+
+    // a queued retransmission may have been acknowledged in the meantime, and retired then; one the ackno
+    // landed inside is still outstanding, and goes again whole
+    const size_t i = find_outstanding( seqno );
+    if ( i == m_outstanding_.size() || m_outstanding_[i].seqno != seqno )
+      continue;
+
+    // or SACKed, unless it is the one at the ackno: a peer still holding that would have acknowledged it
+    const OutstandingMessage& outstanding = m_outstanding_[i];
+    if ( i == 0 || !outstanding.sacked )
+      message = outstanding.message;
+  }
 
-  TCPSenderMessage message = std::move( m_send_queue_.front() );
-  m_send_queue_.pop();
+  if ( !message.has_value() && m_unsent > 0 )
+    message = m_outstanding_[m_outstanding_.size() - m_unsent--].message;
 
-  if ( !m_retransmission_timer_.is_running() )
+  if ( message.has_value() && !m_retransmission_timer_.is_running() )
     m_retransmission_timer_.restart( m_RTO_ms_.value() );
 
   return message;
@@ -109,18 +385,30 @@ void TCPSender::push( Reader& outbound_stream )
 
   uint64_t window_right = m_window_size == 0 ? m_window_left + 1 : m_window_left + m_window_size;
 
-  while ( !m_fin_pushed && get_absolute_seqno() + TCPConfig::MAX_PAYLOAD_SIZE <= window_right ) {
-    read( outbound_stream, TCPConfig::MAX_PAYLOAD_SIZE, payload );
+  // in SACK-based recovery, only what is still in the network counts against the congestion window (RFC 6675)
+  if ( m_congestion_control_ ) {
+    const uint64_t cwnd = m_congestion_control_->cwnd();
+    const uint64_t in_network = m_sack && m_in_recovery ? pipe() : sequence_numbers_in_flight();
+    window_right = min( window_right, get_absolute_seqno() + ( cwnd > in_network ? cwnd - in_network : 0 ) );
+  }
+
+  while ( !m_fin_pushed && get_absolute_seqno() + m_segment_size <= window_right ) {
+    const optional<uint64_t> probe = next_probe( outbound_stream, window_right );
+    if ( hold_tail( outbound_stream, probe.value_or( m_segment_size ) ) )
+      return;
+
+    read( outbound_stream, probe.value_or( m_segment_size ), payload );
     bool is_fin_msg = payload.size() + get_absolute_seqno() < window_right && outbound_stream.is_finished();
 
     if ( payload.empty() && !is_fin_msg )
       break;
 
     m_fin_pushed = m_fin_pushed || is_fin_msg;
-    push_message( std::move( payload ), false, is_fin_msg );
+    push_message( std::move( payload ), false, is_fin_msg, probe.has_value() );
   }
 
-  if ( !m_fin_pushed && get_absolute_seqno() < window_right ) {
+  if ( !m_fin_pushed && get_absolute_seqno() < window_right
+       && !hold_tail( outbound_stream, window_right - get_absolute_seqno() ) ) {
     read( outbound_stream, window_right - get_absolute_seqno(), payload );
     bool is_fin_msg = payload.size() + get_absolute_seqno() < window_right && outbound_stream.is_finished();
 
@@ -138,39 +426,126 @@ TCPSenderMessage TCPSender::send_empty_message() const
   return message;
 }
 
-void TCPSender::receive( const TCPReceiverMessage& msg )
+void TCPSender::receive( const TCPReceiverMessage& msg, uint64_t segment_length )
 {
   if ( !msg.ackno.has_value() )
     return;
 
   uint64_t absolute_ackno = msg.ackno.value().unwrap( m_isn_, m_window_left );
+  const uint64_t window_size = static_cast<uint64_t>( msg.window_size ) << m_window_scale;
+
+  const bool newly_sacked = m_sack && update_scoreboard( msg.sack );
+
+  // a duplicate ACK carries no data, SYN or FIN, acknowledges nothing new while data is outstanding, and
+  // either SACKs new data (RFC 6675 2) or doesn't update the window (RFC 5681 2); a zero window holds back
+  // everything behind the hole anyway
+  const bool duplicate = m_fast_retransmit && segment_length == 0 && absolute_ackno == m_window_left
+                         && !m_outstanding_.empty()
+                         && ( newly_sacked || ( window_size == m_window_size && window_size > 0 ) );
+
+  if ( newly_sacked && m_fast_retransmit )
+    mark_lost();
 
   bool sucessful_recipt = false;
+  optional<uint64_t> rtt_sample;
 
-  while ( !m_outstanding_messages_.empty() ) {
-    uint64_t wait_for_ackno
-      = m_outstanding_messages_.begin()->first + m_outstanding_messages_.begin()->second.sequence_length();
+  while ( !m_outstanding_.empty() ) {
+    const OutstandingMessage& outstanding = m_outstanding_.front();
+    uint64_t wait_for_ackno = outstanding.seqno + outstanding.message.sequence_length();
 
     if ( absolute_ackno < wait_for_ackno || absolute_ackno > get_absolute_seqno() )
       break;
 
-    // sucessful receipt
-    m_outstanding_messages_.erase( m_outstanding_messages_.begin() );
+    // sucessful receipt; only a segment sent once gives an unambiguous RTT (Karn's algorithm)
+    if ( !outstanding.retransmitted )
+      rtt_sample = m_timer_ - outstanding.sent_ms;
+
+    if ( outstanding.probe )
+      probe_received( m_outstanding_.front() );
+
+    m_outstanding_.pop_front();
     sucessful_recipt = true;
   }
 
+  m_unsent = min( m_unsent, m_outstanding_.size() ); // acknowledged before it was even sent
+
+  if ( rtt_sample.has_value() ) {
+    m_RTO_ms_.add_sample( rtt_sample.value() );
+
+    if ( m_congestion_control_ )
+      m_congestion_control_->on_rtt_sample( rtt_sample.value() );
+  }
+
   if ( sucessful_recipt ) {
+    // the SYN doesn't count towards the bytes acknowledged
+    const uint64_t bytes_acked = absolute_ackno - m_window_left - ( m_window_left == 0 );
+    m_duplicate_acks = 0;
+
+    if ( m_in_recovery && absolute_ackno < m_recover && m_sack ) {
+      // partial ACK: the segment after the one repaired was lost as well, unless it was resent already;
+      // it goes out below with any other hole, as the pipe allows
+      auto& earliest = m_outstanding_.front();
+      earliest.lost = earliest.lost || !earliest.resent;
+      m_holes_pending = true;
+    } else if ( m_in_recovery && absolute_ackno < m_recover ) {
+      // partial ACK: the segment after the one repaired was lost as well, resend it right away
+      retransmit_earliest();
+
+      if ( m_congestion_control_ )
+        m_congestion_control_->deflate( bytes_acked );
+    } else if ( m_in_recovery ) {
+      m_in_recovery = false;
+
+      if ( m_congestion_control_ )
+        m_congestion_control_->end_recovery();
+    } else if ( m_congestion_control_ )
+      m_congestion_control_->on_ack( bytes_acked, m_timer_ );
+
     m_RTO_ms_.set_timeout( RetransmissionTimeout::SUCCESSFUL_RECEIPT );
     m_consecutive_retransmissions = 0;
     m_window_left = absolute_ackno;
 
-    if ( !m_outstanding_messages_.empty() )
+    if ( !m_outstanding_.empty() )
       m_retransmission_timer_.restart( m_RTO_ms_.value() );
     else
       m_retransmission_timer_.stop();
+  } else if ( duplicate ) {
+    m_duplicate_acks++;
+
+    const bool earliest_lost = m_sack && m_outstanding_.front().lost;
+
+    if ( m_in_recovery ) {
+      // with SACK, the pipe already knows what has left the network
+      if ( m_congestion_control_ && !m_sack )
+        m_congestion_control_->inflate( m_congestion_control_->mss() );
+    } else if ( ( m_duplicate_acks >= TCPConfig::DUPACK_THRESHOLD || earliest_lost )
+                && absolute_ackno >= m_recover ) {
+      // fast retransmit, unless the duplicates are about data sent before the last recovery or timeout
+      // (RFC 6582 3.2); without SACK, the three segments that got through have left the network
+      m_in_recovery = true;
+      m_recover = get_absolute_seqno();
+
+      if ( m_congestion_control_ ) {
+        m_congestion_control_->on_loss( sequence_numbers_in_flight(), m_timer_ );
+        if ( !m_sack )
+          m_congestion_control_->inflate( TCPConfig::DUPACK_THRESHOLD * m_congestion_control_->mss() );
+      }
+
+      if ( m_sack ) {
+        // RFC 6675 4: the segment at the ackno is lost, whatever IsLost() says, and goes first
+        for ( size_t i = 0; i < m_outstanding_.size(); ++i )
+          m_outstanding_[i].resent = false;
+        m_outstanding_.front().lost = true;
+        m_holes_pending = true;
+      } else
+        retransmit_earliest();
+    }
   }
 
-  m_window_size = msg.window_size;
+  if ( m_sack && !m_outstanding_.empty() )
+    retransmit_holes();
+
+  m_window_size = window_size;
 }
 
 void TCPSender::tick( const uint64_t ms_since_last_tick )
@@ -179,12 +554,31 @@ void TCPSender::tick( const uint64_t ms_since_last_tick )
   m_retransmission_timer_.elapse( ms_since_last_tick );
 
   if ( m_retransmission_timer_.is_timeout() ) {
-    // resend the earliest outstanding message
-    m_send_queue_.push( m_outstanding_messages_.begin()->second );
+    // with SACK, everything is presumed lost, SACKed or not: the peer may have dropped what it held since
+    // (RFC 2018 8). The earliest goes now, the other holes as ACKs come back, SACKing again what the peer
+    // still holds, and the window allows (RFC 6675 5.1), instead of one timeout each
+    if ( m_sack ) {
+      for ( size_t i = 0; i < m_outstanding_.size(); ++i ) {
+        m_outstanding_[i].sacked = false;
+        m_outstanding_[i].lost = true;
+        m_outstanding_[i].resent = false;
+      }
+      m_holes_pending = true;
+    }
+
+    retransmit_earliest();
+
+    // start over in slow start; duplicate ACKs for what was sent so far are no new loss
+    m_duplicate_acks = 0;
+    m_in_recovery = false;
+    m_recover = get_absolute_seqno();
 
     if ( m_window_size > 0 ) {
       m_RTO_ms_.set_timeout( RetransmissionTimeout::TIMEOUT );
       m_consecutive_retransmissions++;
+
+      if ( m_congestion_control_ )
+        m_congestion_control_->on_timeout( sequence_numbers_in_flight(), m_timer_ );
     }
 
     m_retransmission_timer_.restart( m_RTO_ms_.value() );
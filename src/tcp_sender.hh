@@ -1,11 +1,18 @@
 #pragma once
 
 #include "byte_stream.hh"
+#include "congestion_control.hh"
+#include "path_mtu_discovery.hh"
 #include "tcp_receiver_message.hh"
 #include "tcp_sender_message.hh"
-#include <map>
+#include <cstddef>
+#include <memory>
+#include <optional>
 #include <queue>
 #include <utility>
+#include <vector>
+
+class TCPConfig;
 
 class RetransmissionTimeout
 {
@@ -13,6 +20,15 @@ private:
   uint64_t m_value {};
   uint64_t m_init_value {};
 
+  // RTT estimation (RFC 6298), if enabled: the RTO follows SRTT + 4 * RTTVAR within [m_min, m_max]
+  bool m_estimate {};
+  uint64_t m_min {};
+  uint64_t m_max { UINT64_MAX };
+  std::optional<uint64_t> m_srtt {};
+  uint64_t m_rttvar {};
+
+  uint64_t estimate() const;
+
 public:
   enum RestransmissionEvent
   {
@@ -21,8 +37,12 @@ public:
   };
 
   explicit RetransmissionTimeout( uint64_t initial_RTO_ms );
+  RetransmissionTimeout( uint64_t initial_RTO_ms, uint64_t min_RTO_ms, uint64_t max_RTO_ms ); // with estimation
   uint64_t value() const { return m_value; }
   void set_timeout( RestransmissionEvent event );
+  void add_sample( uint64_t rtt_ms ); // an RTT measured on a segment that was sent only once
+  std::optional<uint64_t> srtt() const { return m_srtt; }
+  uint64_t rttvar() const { return m_rttvar; }
 };
 
 class RetransmissionTimer
@@ -41,11 +61,79 @@ public:
   void elapse( uint64_t ms_time );
 };
 
+// A queue in a ring of slots that doubles when full: appending at the back and retiring from the front move
+// no other element, and allocate nothing once the ring has grown to the largest size it is used at
+template<class T>
+class RetransmissionRing
+{
+private:
+  std::vector<std::optional<T>> m_slots {}; // a power of two of them, or none; empty unless in use
+  size_t m_head {};
+  size_t m_size {};
+
+  std::optional<T>& slot( size_t i ) { return m_slots[( m_head + i ) & ( m_slots.size() - 1 )]; }
+  const std::optional<T>& slot( size_t i ) const { return m_slots[( m_head + i ) & ( m_slots.size() - 1 )]; }
+
+public:
+  bool empty() const { return m_size == 0; }
+  size_t size() const { return m_size; }
+
+  // the i-th element from the front
+  T& operator[]( size_t i ) { return *slot( i ); }
+  const T& operator[]( size_t i ) const { return *slot( i ); }
+  T& front() { return ( *this )[0]; }
+
+  void push_back( T value )
+  {
+    if ( m_size == m_slots.size() ) {
+      std::vector<std::optional<T>> slots( m_slots.empty() ? 16 : 2 * m_slots.size() );
+      for ( size_t i = 0; i < m_size; ++i )
+        slots[i] = std::move( slot( i ) );
+      m_slots = std::move( slots );
+      m_head = 0;
+    }
+
+    slot( m_size++ ).emplace( std::move( value ) );
+  }
+
+  // Insert before the i-th element, moving the ones from there on back
+  void insert( size_t i, T value )
+  {
+    push_back( std::move( value ) );
+    for ( size_t j = m_size - 1; j > i; --j )
+      std::swap( slot( j ), slot( j - 1 ) );
+  }
+
+  void pop_front()
+  {
+    slot( 0 ).reset(); // release what it holds now rather than when the slot is reused
+    m_head = ( m_head + 1 ) & ( m_slots.size() - 1 );
+    m_size--;
+  }
+};
+
 class TCPSender
 {
 private:
-  std::map<uint64_t, TCPSenderMessage> m_outstanding_messages_ {}; // seqno -> TCPSenderMessage
-  std::queue<TCPSenderMessage> m_send_queue_ {};
+  struct OutstandingMessage
+  {
+    uint64_t seqno {}; // absolute
+    TCPSenderMessage message;
+    uint64_t sent_ms {};   // m_timer_ when first sent
+    bool retransmitted {}; // no RTT sample from it then (Karn's algorithm)
+    bool probe {};         // a path MTU probe, larger than the segments known to get through
+
+    // SACK scoreboard (RFC 6675)
+    bool sacked {}; // covered by a SACK block: the receiver holds it, so it is never resent
+    bool lost {};   // presumed lost, to be resent as the pipe allows
+    bool resent {}; // resent since the current loss recovery began, so in the network twice
+  };
+
+  // every segment pushed and not acknowledged yet, in seqno order; the last m_unsent of them haven't been sent
+  RetransmissionRing<OutstandingMessage> m_outstanding_ {};
+  size_t m_unsent {};
+  std::queue<uint64_t> m_resend_queue_ {}; // seqnos of the outstanding segments to send again, in order
+  uint64_t m_next_seqno {};                // absolute seqno after the last segment pushed
 
   bool m_syc_pushed {};
   bool m_fin_pushed {};
@@ -55,15 +143,55 @@ private:
   Wrap32 m_isn_ { 0 };
   RetransmissionTimeout m_RTO_ms_ { 0 };
   uint64_t m_consecutive_retransmissions {};
+  uint64_t m_max_segment_size;                   // the MSS: what both sides accept
+  uint64_t m_segment_size;                       // payload bytes per segment, up to the MSS
+  uint64_t m_option_room {};                     // bytes of the MSS kept for the options a segment may carry
+  std::optional<PathMTUDiscovery> m_path_mtu {}; // searching for a larger segment size, if enabled
   uint64_t m_window_left { 0 };
   uint64_t m_window_size { 1 }; // for syn
-
-  uint64_t get_absolute_seqno() const;
-  void push_message( std::string payload, bool syn = false, bool fin = false );
+  uint8_t m_window_scale { 0 };  // shift the peer applies to its advertised window (RFC 7323)
+  bool m_sack {};                // the peer reports SACK blocks (RFC 2018)
+  bool m_holes_pending {};       // some segment is marked lost and not resent yet
+
+  // small-segment coalescing: Nagle's algorithm (RFC 896), if enabled, and corking
+  bool m_nagle {};
+  bool m_corked {};
+  uint64_t m_push_seqno {}; // the stream up to here was uncorked, so goes out without waiting for more
+
+  std::unique_ptr<CongestionControl> m_congestion_control_ {}; // no congestion window if empty
+
+  // fast retransmit and fast recovery (RFC 5681 3.2, RFC 6582), if enabled
+  bool m_fast_retransmit {};
+  uint64_t m_duplicate_acks {};
+  bool m_in_recovery {};
+  uint64_t m_recover {}; // next seqno when the last recovery (or timeout) happened; ends the recovery once acked
+
+  uint64_t get_absolute_seqno() const { return m_next_seqno; }
+  size_t find_outstanding( uint64_t seqno ) const; // index of the first outstanding segment at or after seqno
+  void push_message( std::string payload, bool syn = false, bool fin = false, bool probe = false );
+  void retransmit_earliest();
+  size_t resend( size_t i ); // queue outstanding segment i to go again; returns how many segments that became
+  bool hold_tail( const Reader& outbound_stream, uint64_t len ) const; // wait for more than `len` bytes to send?
+
+  // path MTU discovery (RFC 8899)
+  void update_segment_size(); // after the MSS, the path MTU or the options sent change
+  std::optional<uint64_t> next_probe( const Reader& outbound_stream, uint64_t window_right ) const;
+  void probe_received( OutstandingMessage& outstanding );
+  size_t split_probe( size_t i ); // into segments of the size known to get through; returns how many
+
+  // SACK-based loss recovery (RFC 6675)
+  bool update_scoreboard( const std::vector<SACKBlock>& blocks ); // true if anything was newly SACKed
+  void mark_lost();                                                // IsLost() for every segment not SACKed
+  void retransmit_holes();                                         // NextSeg() rule 1, limited by the pipe
 
 public:
-  /* Construct TCP sender with given default Retransmission Timeout and possible ISN */
-  TCPSender( uint64_t initial_RTO_ms, std::optional<Wrap32> fixed_isn );
+  /* Construct TCP sender with given default Retransmission Timeout, possible ISN and congestion control */
+  TCPSender( uint64_t initial_RTO_ms,
+             std::optional<Wrap32> fixed_isn,
+             std::unique_ptr<CongestionControl> congestion_control = nullptr );
+
+  /* Construct TCP sender as configured (RTO estimation, congestion control...) */
+  explicit TCPSender( const TCPConfig& cfg );
 
   /* Push bytes from the outbound stream */
   void push( Reader& outbound_stream );
@@ -74,8 +202,25 @@ public:
   /* Generate an empty TCPSenderMessage */
   TCPSenderMessage send_empty_message() const;
 
-  /* Receive an act on a TCPReceiverMessage from the peer's receiver */
-  void receive( const TCPReceiverMessage& msg );
+  /* Receive an act on a TCPReceiverMessage from the peer's receiver, carried by a segment that occupies
+     segment_length sequence numbers (only an ACK carrying nothing else can be a duplicate ACK) */
+  void receive( const TCPReceiverMessage& msg, uint64_t segment_length = 0 );
+
+  /* Interpret the peer's windows in units of 2^shift from now on (once window scaling has been negotiated) */
+  void set_window_scale( uint8_t shift ) { m_window_scale = shift; }
+
+  /* Send segments no larger than the peer accepts (its MSS option) */
+  void set_peer_mss( uint64_t mss );
+
+  /* Cork: hold back a tail of the outbound stream smaller than a segment until it fills one or the stream is
+     closed, even with nothing unacknowledged. Uncork: send everything written so far as soon as the windows
+     allow, Nagle's algorithm or not. */
+  void cork() { m_corked = true; }
+  void uncork( const Reader& outbound_stream );
+
+  /* Keep a scoreboard of the peer's SACK blocks from now on, and resend only the holes (once SACK has been
+     negotiated); leave room in every segment for the SACK blocks it may carry back */
+  void use_sack();
 
   /* Time has passed by the given # of milliseconds since the last time the tick() method was called. */
   void tick( const uint64_t ms_since_last_tick );
@@ -83,4 +228,11 @@ public:
   /* Accessors for use in testing */
   uint64_t sequence_numbers_in_flight() const;  // How many sequence numbers are outstanding?
   uint64_t consecutive_retransmissions() const; // How many consecutive *re*transmissions have happened?
+  const CongestionControl* congestion_control() const { return m_congestion_control_.get(); } // cwnd, ssthresh
+  const RetransmissionTimeout& retransmission_timeout() const { return m_RTO_ms_; }            // RTO, SRTT
+  bool in_fast_recovery() const { return m_in_recovery; }
+  uint64_t segment_size() const { return m_segment_size; } // payload bytes per segment
+  uint64_t max_segment_size() const { return m_max_segment_size; }
+  const std::optional<PathMTUDiscovery>& path_mtu_discovery() const { return m_path_mtu; }
+  uint64_t pipe() const; // sequence numbers still in the network: not SACKed nor lost, or resent (RFC 6675)
 };
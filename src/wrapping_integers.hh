@@ -1,11 +1,15 @@
 #pragma once
 
 #include <cstdint>
+#include <span>
 
 /*
  * The Wrap32 type represents a 32-bit unsigned integer that:
  *    - starts at an arbitrary "zero point" (initial value), and
  *    - wraps back to zero when it reaches 2^32 - 1.
+ *
+ * Everything here is constexpr and branch-free, so sequence-number arithmetic costs a few
+ * integer instructions and can be folded at compile time.
  */
 
 class Wrap32
@@ -14,10 +18,13 @@ protected:
   uint32_t raw_value_ {};
 
 public:
-  explicit Wrap32( uint32_t raw_value ) : raw_value_( raw_value ) {}
+  constexpr explicit Wrap32( uint32_t raw_value ) : raw_value_( raw_value ) {}
 
   /* Construct a Wrap32 given an absolute sequence number n and the zero point. */
-  static Wrap32 wrap( uint64_t n, Wrap32 zero_point );
+  static constexpr Wrap32 wrap( uint64_t n, Wrap32 zero_point )
+  {
+    return Wrap32 { static_cast<uint32_t>( n ) + zero_point.raw_value_ };
+  }
 
   /*
    * The unwrap method returns an absolute sequence number that wraps to this Wrap32, given the zero point
@@ -26,8 +33,35 @@ public:
    * There are many possible absolute sequence numbers that all wrap to the same Wrap32.
    * The unwrap method should return the one that is closest to the checkpoint.
    */
-  uint64_t unwrap( Wrap32 zero_point, uint64_t checkpoint ) const;
+  constexpr uint64_t unwrap( Wrap32 zero_point, uint64_t checkpoint ) const
+  {
+    // signed step from the checkpoint to the nearest candidate, in [-2^31, 2^31)
+    const auto delta = static_cast<int32_t>( raw_value_ - zero_point.raw_value_ - static_cast<uint32_t>( checkpoint ) );
+    const uint64_t nearest = checkpoint + static_cast<uint64_t>( static_cast<int64_t>( delta ) );
 
-  Wrap32 operator+( uint32_t n ) const { return Wrap32 { raw_value_ + n }; }
-  bool operator==( const Wrap32& other ) const { return raw_value_ == other.raw_value_; }
+    // if that would be negative, the next candidate up is the closest valid one
+    const uint64_t below_zero = static_cast<uint64_t>( delta < 0 )
+                                & static_cast<uint64_t>( checkpoint < static_cast<uint64_t>( -static_cast<int64_t>( delta ) ) );
+    return nearest + ( below_zero << 32 );
+  }
+
+  /*
+   * Unwrap every seqno in `seqnos` into the same position of `out` (which must be at least as long),
+   * all relative to one zero point and checkpoint. Intended for processing received segments in bulk.
+   */
+  static void unwrap( std::span<const Wrap32> seqnos,
+                      Wrap32 zero_point,
+                      uint64_t checkpoint,
+                      std::span<uint64_t> out );
+
+  /*
+   * Serial number arithmetic (RFC 1982): the signed distance from this seqno forward to `other`,
+   * and the ordering it implies. Seqnos exactly 2^31 apart compare as neither before nor after.
+   */
+  constexpr int32_t distance_to( Wrap32 other ) const { return static_cast<int32_t>( other.raw_value_ - raw_value_ ); }
+  constexpr bool before( Wrap32 other ) const { return distance_to( other ) > 0; }
+  constexpr bool after( Wrap32 other ) const { return other.distance_to( *this ) > 0; }
+
+  constexpr Wrap32 operator+( uint32_t n ) const { return Wrap32 { raw_value_ + n }; }
+  constexpr bool operator==( const Wrap32& other ) const { return raw_value_ == other.raw_value_; }
 };
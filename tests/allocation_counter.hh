@@ -0,0 +1,30 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+// Count every heap allocation made by the process, for the benchmarks. This replaces the global operator new
+// and delete, so include it from exactly one translation unit of a program.
+inline std::atomic<uint64_t> allocations { 0 }; // NOLINT(*-avoid-non-const-global-variables)
+
+void* operator new( std::size_t size )
+{
+  allocations.fetch_add( 1, std::memory_order_relaxed );
+  if ( void* ptr = std::malloc( size ? size : 1 ) ) { // NOLINT(*-no-malloc)
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete( void* ptr ) noexcept
+{
+  std::free( ptr ); // NOLINT(*-no-malloc)
+}
+
+void operator delete( void* ptr, std::size_t /* size */ ) noexcept
+{
+  std::free( ptr ); // NOLINT(*-no-malloc)
+}
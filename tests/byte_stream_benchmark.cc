@@ -0,0 +1,240 @@
+#include "allocation_counter.hh"
+#include "byte_stream.hh"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+/*
+ * Benchmark suite for ByteStream storage engines. Sweeps capacity, write size, read size and
+ * storage mode in a single-threaded push/peek/pop loop, then runs a two-thread producer/consumer
+ * scenario, and prints one JSON array with throughput, ns per operation and heap allocations per MB.
+ */
+
+namespace {
+
+constexpr size_t input_len = 1 << 22;
+
+struct Result
+{
+  string scenario;
+  ByteStream::Storage storage;
+  size_t capacity;
+  size_t write_size;
+  size_t read_size;
+  double seconds;
+  uint64_t ops;
+  uint64_t allocs;
+
+  string json() const
+  {
+    static constexpr array<const char*, 3> storage_names { "ring", "chunked", "mirrored" };
+    const double megabytes = static_cast<double>( input_len ) / 1e6;
+
+    ostringstream out;
+    out << fixed << setprecision( 3 );
+    out << R"({"scenario": ")" << scenario << R"(", "storage": ")"
+        << storage_names.at( static_cast<size_t>( storage ) ) << R"(", "capacity": )" << capacity
+        << R"(, "write_size": )" << write_size << R"(, "read_size": )" << read_size << R"(, "bytes": )"
+        << input_len << R"(, "gbit_per_s": )" << 8 * static_cast<double>( input_len ) / seconds / 1e9
+        << R"(, "ns_per_op": )" << seconds * 1e9 / static_cast<double>( ops ) << R"(, "allocs_per_mb": )"
+        << static_cast<double>( allocs ) / megabytes << "}";
+    return out.str();
+  }
+};
+
+string make_data()
+{
+  default_random_engine rd { 2024 };
+  uniform_int_distribution<char> ud;
+  string ret;
+  ret.reserve( input_len );
+  for ( size_t i = 0; i < input_len; ++i ) {
+    ret += ud( rd );
+  }
+  return ret;
+}
+
+vector<string> split( const string& data, size_t write_size )
+{
+  vector<string> ret;
+  for ( size_t i = 0; i < data.size(); i += write_size ) {
+    ret.emplace_back( data.substr( i, write_size ) );
+  }
+  return ret;
+}
+
+// One thread alternately pushes a write_size chunk (when it fits) and pops up to read_size bytes.
+Result single_thread( const string& data,
+                      ByteStream::Storage storage,
+                      size_t capacity,   // NOLINT(bugprone-easily-swappable-parameters)
+                      size_t write_size, // NOLINT(bugprone-easily-swappable-parameters)
+                      size_t read_size ) // NOLINT(bugprone-easily-swappable-parameters)
+{
+  vector<string> chunks = split( data, write_size );
+  ByteStream bs { capacity, storage };
+  string output;
+  output.reserve( data.size() );
+  uint64_t ops = 0;
+  size_t next_chunk = 0;
+
+  const uint64_t allocs_before = allocations.load();
+  const auto start_time = steady_clock::now();
+
+  while ( not bs.reader().is_finished() ) {
+    if ( next_chunk == chunks.size() ) {
+      bs.writer().close();
+    } else if ( chunks[next_chunk].size() <= bs.writer().available_capacity() ) {
+      bs.writer().push( move( chunks[next_chunk++] ) );
+      ++ops;
+    }
+
+    if ( bs.reader().bytes_buffered() ) {
+      const auto peeked = bs.reader().peek().substr( 0, read_size );
+      output += peeked;
+      bs.reader().pop( peeked.size() );
+      ++ops;
+    }
+  }
+
+  const auto stop_time = steady_clock::now();
+  const uint64_t allocs = allocations.load() - allocs_before;
+
+  if ( output != data ) {
+    throw runtime_error( "Mismatch between data written and read" );
+  }
+
+  return { "single_thread",
+           storage,
+           capacity,
+           write_size,
+           read_size,
+           duration_cast<duration<double>>( stop_time - start_time ).count(),
+           ops,
+           allocs };
+}
+
+// A producer and a consumer thread share one ByteStream behind a mutex.
+Result producer_consumer( const string& data,
+                          ByteStream::Storage storage,
+                          size_t capacity,   // NOLINT(bugprone-easily-swappable-parameters)
+                          size_t write_size, // NOLINT(bugprone-easily-swappable-parameters)
+                          size_t read_size ) // NOLINT(bugprone-easily-swappable-parameters)
+{
+  vector<string> chunks = split( data, write_size );
+  ByteStream bs { capacity, storage };
+  mutex bs_mutex;
+  string output;
+  output.reserve( data.size() );
+  atomic<uint64_t> ops { 0 };
+
+  const uint64_t allocs_before = allocations.load();
+  const auto start_time = steady_clock::now();
+
+  thread producer { [&] {
+    for ( auto& chunk : chunks ) {
+      while ( true ) {
+        {
+          const lock_guard lock { bs_mutex };
+          if ( chunk.size() <= bs.writer().available_capacity() ) {
+            bs.writer().push( move( chunk ) );
+            break;
+          }
+        }
+        this_thread::yield(); // let the consumer drain without contending for the lock
+      }
+      ops.fetch_add( 1, memory_order_relaxed );
+    }
+    const lock_guard lock { bs_mutex };
+    bs.writer().close();
+  } };
+
+  while ( true ) {
+    {
+      const lock_guard lock { bs_mutex };
+      if ( bs.reader().is_finished() ) {
+        break;
+      }
+      if ( bs.reader().bytes_buffered() ) {
+        const auto peeked = bs.reader().peek().substr( 0, read_size );
+        output += peeked;
+        bs.reader().pop( peeked.size() );
+        ops.fetch_add( 1, memory_order_relaxed );
+        continue;
+      }
+    }
+    this_thread::yield();
+  }
+
+  producer.join();
+
+  const auto stop_time = steady_clock::now();
+  const uint64_t allocs = allocations.load() - allocs_before;
+
+  if ( output != data ) {
+    throw runtime_error( "Mismatch between data written and read" );
+  }
+
+  return { "producer_consumer",
+           storage,
+           capacity,
+           write_size,
+           read_size,
+           duration_cast<duration<double>>( stop_time - start_time ).count(),
+           ops.load(),
+           allocs };
+}
+
+void program_body()
+{
+  const string data = make_data();
+  vector<Result> results;
+
+  for ( const auto storage : { ByteStream::Storage::Ring, ByteStream::Storage::Chunked, ByteStream::Storage::Mirrored } ) {
+    for ( const size_t capacity : { 4096, 65536, 1048576 } ) {
+      for ( const size_t write_size : { 128, 1500, 16384 } ) {
+        for ( const size_t read_size : { 128, 1460, 16384 } ) {
+          if ( write_size <= capacity ) {
+            results.push_back( single_thread( data, storage, capacity, write_size, read_size ) );
+          }
+        }
+      }
+    }
+
+    results.push_back( producer_consumer( data, storage, 65536, 1500, 1460 ) );
+    results.push_back( producer_consumer( data, storage, 1048576, 16384, 16384 ) );
+  }
+
+  cout << "[\n";
+  for ( size_t i = 0; i < results.size(); ++i ) {
+    cout << "  " << results[i].json() << ( i + 1 < results.size() ? ",\n" : "\n" );
+  }
+  cout << "]\n";
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
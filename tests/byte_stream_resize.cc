@@ -0,0 +1,103 @@
+#include "byte_stream.hh"
+#include "byte_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    {
+      ByteStreamTestHarness test { "grow", 4 };
+
+      test.execute( Push { "abcd" } );
+      test.execute( AvailableCapacity { 0 } );
+      test.execute( SetCapacity { 8 } );
+      test.execute( AvailableCapacity { 4 } );
+      test.execute( Push { "efghij" } );
+      test.execute( BytesPushed { 8 } );
+      test.execute( ReadAll { "abcdefgh" } );
+      test.execute( AvailableCapacity { 8 } );
+    }
+
+    {
+      ByteStreamTestHarness test { "grow-while-wrapped", 4 };
+
+      test.execute( Push { "abcd" } );
+      test.execute( Pop { 3 } );
+      test.execute( Push { "efg" } );
+      test.execute( SetCapacity { 7 } );
+      test.execute( BytesBuffered { 4 } );
+      test.execute( Push { "hijk" } );
+      test.execute( BytesBuffered { 7 } );
+      test.execute( Pop { 2 } );
+      test.execute( Push { "lm" } );
+      test.execute( ReadAll { "fghijlm" } );
+    }
+
+    {
+      ByteStreamTestHarness test { "shrink", 8 };
+
+      test.execute( Push { "abcdef" } );
+      test.execute( Pop { 4 } );
+      test.execute( SetCapacity { 3 } );
+      test.execute( AvailableCapacity { 1 } );
+      test.execute( Push { "ghi" } );
+      test.execute( ReadAll { "efg" } );
+      test.execute( Push { "jklm" } );
+      test.execute( ReadAll { "jkl" } );
+    }
+
+    {
+      ByteStreamTestHarness test { "small changes keep the storage", 64000 };
+
+      test.execute( Push { string( 60000, 'a' ) } );
+      test.execute( Pop { 10000 } );
+      test.execute( Push { string( 10000, 'b' ) } );
+      for ( uint64_t capacity = 63000; capacity >= 57000; capacity -= 1000 ) {
+        test.execute( SetCapacity { capacity }.keeping_storage() );
+      }
+      test.execute( SetCapacity { 64000 }.keeping_storage() );
+      test.execute( AvailableCapacity { 4000 } );
+      test.execute( Push { string( 4000, 'c' ) } );
+      test.execute( Peek { string( 50000, 'a' ) + string( 10000, 'b' ) + string( 4000, 'c' ) } );
+
+      // a large shrink gives the memory back, and the bytes keep their order
+      test.execute( Pop { 40000 } );
+      test.execute( SetCapacity { 24000 } );
+      test.execute( AvailableCapacity { 0 } );
+      test.execute( ReadAll { string( 10000, 'a' ) + string( 10000, 'b' ) + string( 4000, 'c' ) } );
+    }
+
+    {
+      ByteStreamTestHarness test { "never below bytes buffered", 8 };
+
+      test.execute( Push { "abcdef" } );
+      test.execute( SetCapacity { 2 } );
+      test.execute( AvailableCapacity { 0 } );
+      test.execute( BytesBuffered { 6 } );
+      test.execute( Pop { 5 } );
+      test.execute( Push { "gh" } );
+      test.execute( ReadAll { "fgh" } );
+    }
+
+    {
+      ByteStreamTestHarness test { "resize after close", 2 };
+
+      test.execute( Push { "ab" } );
+      test.execute( Close {} );
+      test.execute( SetCapacity { 16 } );
+      test.execute( IsClosed { true } );
+      test.execute( ReadAll { "ab" } );
+      test.execute( IsFinished { true } );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
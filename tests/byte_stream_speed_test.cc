@@ -7,6 +7,7 @@
 #include <iostream>
 #include <queue>
 #include <random>
+#include <sstream>
 
 using namespace std;
 using namespace std::chrono;
@@ -15,7 +16,8 @@ void speed_test( const size_t input_len,   // NOLINT(bugprone-easily-swappable-p
                  const size_t capacity,    // NOLINT(bugprone-easily-swappable-parameters)
                  const size_t random_seed, // NOLINT(bugprone-easily-swappable-parameters)
                  const size_t write_size,  // NOLINT(bugprone-easily-swappable-parameters)
-                 const size_t read_size )  // NOLINT(bugprone-easily-swappable-parameters)
+                 const size_t read_size,   // NOLINT(bugprone-easily-swappable-parameters)
+                 const double min_gigabits_per_second = 0.1 )
 {
   // Generate the data to be written
   const string data = [&random_seed, &input_len] {
@@ -81,14 +83,22 @@ void speed_test( const size_t input_len,   // NOLINT(bugprone-easily-swappable-p
   debug_output << "             ByteStream throughput: " << fixed << setprecision( 2 ) << gigabits_per_second
                << " Gbit/s\n";
 
-  if ( gigabits_per_second < 0.1 ) {
-    throw runtime_error( "ByteStream did not meet minimum speed of 0.1 Gbit/s." );
+  if ( gigabits_per_second < min_gigabits_per_second ) {
+    ostringstream msg;
+    msg << "ByteStream did not meet minimum speed of " << min_gigabits_per_second << " Gbit/s.";
+    throw runtime_error( msg.str() );
   }
 }
 
 void program_body()
 {
   speed_test( 1e7, 32768, 789, 1500, 128 );
+  // One byte per call measures per-call overhead, not copying: it runs far below the others and swings with
+  // machine load, so it only guards against a gross regression.
+  speed_test( 1e7, 4096, 790, 1, 1, 0.02 );
+  speed_test( 1e7, 65536, 791, 8192, 8192 );
+  speed_test( 1e7, 1048576, 792, 65536, 1460 );
+  speed_test( 1e7, 1048576, 793, 1500, 128 );
 }
 
 int main()
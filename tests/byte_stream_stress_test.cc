@@ -35,7 +35,11 @@ void stress_test( const size_t input_len,    // NOLINT(bugprone-easily-swappable
     /* write something */
     uniform_int_distribution<size_t> bytes_to_push_dist { 0, data.size() - expected_bytes_pushed };
     const size_t amount_to_push = bytes_to_push_dist( rd );
-    bs.execute( Push { data.substr( expected_bytes_pushed, amount_to_push ) } );
+    if ( bernoulli_distribution {}( rd ) ) {
+      bs.execute( Push { data.substr( expected_bytes_pushed, amount_to_push ) } );
+    } else {
+      bs.execute( ReserveCommit { data.substr( expected_bytes_pushed, amount_to_push ) } );
+    }
     expected_bytes_pushed += min( amount_to_push, expected_available_capacity );
     expected_available_capacity -= min( amount_to_push, expected_available_capacity );
 
@@ -54,8 +58,13 @@ void stress_test( const size_t input_len,    // NOLINT(bugprone-easily-swappable
     if ( expected_bytes_popped + peek_size > expected_bytes_pushed ) {
       throw runtime_error( "ByteStream::reader().peek() returned too-large view" );
     }
+    if ( storage_under_test() == ByteStream::Storage::Mirrored
+         and expected_bytes_popped + peek_size != expected_bytes_pushed ) {
+      throw runtime_error( "mirrored ByteStream::reader().peek() did not return every buffered byte" );
+    }
 
     bs.execute( PeekOnce { data.substr( expected_bytes_popped, peek_size ) } );
+    bs.execute( PeekAll { data.substr( expected_bytes_popped, expected_bytes_pushed - expected_bytes_popped ) } );
 
     uniform_int_distribution<size_t> bytes_to_pop_dist { 0, peek_size };
     const size_t amount_to_pop = bytes_to_pop_dist( rd );
@@ -4,7 +4,10 @@
 #include "common.hh"
 
 #include <concepts>
+#include <cstdlib>
 #include <optional>
+#include <stdexcept>
+#include <string_view>
 #include <utility>
 
 static_assert( sizeof( Reader ) == sizeof( ByteStream ),
@@ -13,11 +16,32 @@ static_assert( sizeof( Reader ) == sizeof( ByteStream ),
 static_assert( sizeof( Writer ) == sizeof( ByteStream ),
                "Please add member variables to the ByteStream base, not the ByteStream Writer." );
 
+/* storage mode under test, selected by the MINNOW_BYTE_STREAM_STORAGE environment variable */
+inline ByteStream::Storage storage_under_test()
+{
+  const char* env = std::getenv( "MINNOW_BYTE_STREAM_STORAGE" ); // NOLINT(*-mt-unsafe)
+  const std::string_view name = env ? env : "ring";
+
+  if ( name == "ring" ) {
+    return ByteStream::Storage::Ring;
+  }
+  if ( name == "chunked" ) {
+    return ByteStream::Storage::Chunked;
+  }
+  if ( name == "mirrored" ) {
+    return ByteStream::Storage::Mirrored;
+  }
+
+  throw std::runtime_error( "unknown MINNOW_BYTE_STREAM_STORAGE: " + std::string { name } );
+}
+
 class ByteStreamTestHarness : public TestHarness<ByteStream>
 {
 public:
   ByteStreamTestHarness( std::string test_name, uint64_t capacity )
-    : TestHarness( move( test_name ), "capacity=" + std::to_string( capacity ), ByteStream { capacity } )
+    : TestHarness( move( test_name ),
+                   "capacity=" + std::to_string( capacity ),
+                   ByteStream { capacity, storage_under_test() } )
   {}
 
   size_t peek_size() { return object().reader().peek().size(); }
@@ -34,6 +58,26 @@ struct Push : public Action<ByteStream>
   void execute( ByteStream& bs ) const override { bs.writer().push( data_ ); }
 };
 
+struct ReserveCommit : public Action<ByteStream>
+{
+  std::string data_;
+
+  explicit ReserveCommit( std::string data ) : data_( move( data ) ) {}
+  std::string description() const override
+  {
+    return "reserve, fill and commit \"" + Printer::prettify( data_ ) + "\"";
+  }
+  void execute( ByteStream& bs ) const override
+  {
+    std::string_view remaining = data_;
+    for ( const auto region : bs.writer().reserve( data_.size() ) ) {
+      remaining.copy( region.data(), region.size() );
+      remaining.remove_prefix( region.size() );
+    }
+    bs.writer().commit( data_.size() - remaining.size() );
+  }
+};
+
 struct Close : public Action<ByteStream>
 {
   std::string description() const override { return "close"; }
@@ -55,6 +99,36 @@ struct Pop : public Action<ByteStream>
   void execute( ByteStream& bs ) const override { bs.reader().pop( len_ ); }
 };
 
+struct SetCapacity : public Action<ByteStream>
+{
+  uint64_t capacity_;
+  bool keep_storage_ {};
+
+  explicit SetCapacity( uint64_t capacity ) : capacity_( capacity ) {}
+
+  // Expect the buffered bytes to stay where they are (the storage isn't reallocated)
+  SetCapacity& keeping_storage()
+  {
+    keep_storage_ = true;
+    return *this;
+  }
+
+  std::string description() const override
+  {
+    return "set_capacity( " + std::to_string( capacity_ ) + " )" + ( keep_storage_ ? " in place" : "" );
+  }
+
+  void execute( ByteStream& bs ) const override
+  {
+    const char* before = bs.reader().peek().data();
+    bs.set_capacity( capacity_ );
+    if ( keep_storage_ and bs.reader().peek().data() != before ) {
+      throw ExpectationViolation( "set_capacity( " + std::to_string( capacity_ )
+                                  + " ) moved the buffered bytes to new storage" );
+    }
+  }
+};
+
 /* expectations */
 
 struct Peek : public Expectation<ByteStream>
@@ -107,6 +181,32 @@ struct PeekOnce : public Peek
   }
 };
 
+struct PeekAll : public Peek
+{
+  using Peek::Peek;
+
+  std::string description() const override
+  {
+    return "peek_all() regions concatenate to \"" + Printer::prettify( output_ ) + "\"";
+  }
+
+  void execute( ByteStream& bs ) const override
+  {
+    std::string got;
+    for ( const auto region : bs.reader().peek_all() ) {
+      if ( region.empty() ) {
+        throw ExpectationViolation { "Reader::peek_all() returned an empty region" };
+      }
+      got += region;
+    }
+
+    if ( got != output_ ) {
+      throw ExpectationViolation { "Expected \"" + Printer::prettify( output_ ) + "\" in buffer, but found \""
+                                   + Printer::prettify( got ) + "\"" };
+    }
+  }
+};
+
 struct IsClosed : public ExpectBool<ByteStream>
 {
   using ExpectBool::ExpectBool;
@@ -0,0 +1,141 @@
+#include "byte_stream.hh"
+#include "byte_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+using TransitionLog = shared_ptr<vector<string>>;
+
+struct WatchReadable : public Action<ByteStream>
+{
+  uint64_t level_;
+  TransitionLog log_;
+
+  WatchReadable( uint64_t level, TransitionLog log ) : level_( level ), log_( move( log ) ) {}
+  string description() const override { return "watch readable with low watermark " + to_string( level_ ); }
+  void execute( ByteStream& bs ) const override
+  {
+    bs.reader().on_readable( level_, [log = log_]( bool ready ) { log->emplace_back( ready ? "+r" : "-r" ); } );
+  }
+};
+
+struct WatchWritable : public Action<ByteStream>
+{
+  uint64_t level_;
+  TransitionLog log_;
+
+  WatchWritable( uint64_t level, TransitionLog log ) : level_( level ), log_( move( log ) ) {}
+  string description() const override { return "watch writable with low watermark " + to_string( level_ ); }
+  void execute( ByteStream& bs ) const override
+  {
+    bs.writer().on_writable( level_, [log = log_]( bool ready ) { log->emplace_back( ready ? "+w" : "-w" ); } );
+  }
+};
+
+struct Transitions : public Expectation<ByteStream>
+{
+  TransitionLog log_;
+  vector<string> expected_;
+
+  Transitions( TransitionLog log, vector<string> expected ) : log_( move( log ) ), expected_( move( expected ) ) {}
+
+  static string join( const vector<string>& events )
+  {
+    string ret;
+    for ( const auto& x : events ) {
+      ret += ret.empty() ? x : " " + x;
+    }
+    return "[" + ret + "]";
+  }
+
+  string description() const override { return "watermark transitions since last check are " + join( expected_ ); }
+
+  void execute( ByteStream& /* unused */ ) const override
+  {
+    if ( *log_ != expected_ ) {
+      throw ExpectationViolation { "Expected watermark transitions " + join( expected_ ) + ", but got "
+                                   + join( *log_ ) };
+    }
+    log_->clear();
+  }
+};
+
+int main()
+{
+  try {
+    {
+      ByteStreamTestHarness test { "readable watermark", 10 };
+      auto log = make_shared<vector<string>>();
+
+      test.execute( WatchReadable { 4, log } );
+      test.execute( Transitions { log, { "-r" } } );
+      test.execute( Push { "ab" } );
+      test.execute( Transitions { log, {} } );
+      test.execute( Push { "cd" } );
+      test.execute( Transitions { log, { "+r" } } );
+      test.execute( Push { "e" } );
+      test.execute( Transitions { log, {} } );
+      test.execute( Pop { 2 } );
+      test.execute( Transitions { log, { "-r" } } );
+      test.execute( Close {} );
+      test.execute( Transitions { log, { "+r" } } );
+      test.execute( ReadAll { "cde" } );
+      test.execute( Transitions { log, {} } );
+      test.execute( IsFinished { true } );
+    }
+
+    {
+      ByteStreamTestHarness test { "writable watermark", 5 };
+      auto log = make_shared<vector<string>>();
+
+      test.execute( WatchWritable { 3, log } );
+      test.execute( Transitions { log, { "+w" } } );
+      test.execute( Push { "ab" } );
+      test.execute( Transitions { log, {} } );
+      test.execute( Push { "c" } );
+      test.execute( Transitions { log, { "-w" } } );
+      test.execute( Push { "defg" } );
+      test.execute( Transitions { log, {} } );
+      test.execute( Pop { 2 } );
+      test.execute( Transitions { log, {} } );
+      test.execute( Pop { 1 } );
+      test.execute( Transitions { log, { "+w" } } );
+      test.execute( ReserveCommit { "xyz" } );
+      test.execute( Transitions { log, { "-w" } } );
+    }
+
+    {
+      ByteStreamTestHarness test { "both watermarks at 1", 2 };
+      auto log = make_shared<vector<string>>();
+
+      test.execute( WatchReadable { 1, log } );
+      test.execute( WatchWritable { 1, log } );
+      test.execute( Transitions { log, { "-r", "+w" } } );
+      test.execute( Push { "cat" } );
+      test.execute( Transitions { log, { "+r", "-w" } } );
+      test.execute( Pop { 1 } );
+      test.execute( Transitions { log, { "+w" } } );
+      test.execute( Pop { 1 } );
+      test.execute( Transitions { log, { "-r" } } );
+    }
+
+    {
+      ByteStreamTestHarness test { "error makes the stream readable", 4 };
+      auto log = make_shared<vector<string>>();
+
+      test.execute( WatchReadable { 1, log } );
+      test.execute( SetError {} );
+      test.execute( Transitions { log, { "-r", "+r" } } );
+      test.execute( HasError { true } );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,98 @@
+#include "peer_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    const string full( TCPConfig::MAX_PAYLOAD_SIZE, 'x' );
+    const Wrap32 isn { 1000 };
+
+    {
+      TCPConfig cfg;
+      cfg.fixed_isn = isn;
+
+      TCPPeerTestHarness test { "Without delayed ACK, every data segment is ACKed right away", cfg };
+      test.execute( Connect {} );
+      test.execute( Write { Side::Client, full } );
+      test.execute( ExpectSent { Side::Client, 1 } );
+      test.execute( Deliver { Side::Client } );
+      test.execute( ExpectSent { Side::Server, 1 } );
+    }
+
+    {
+      TCPConfig cfg;
+      cfg.fixed_isn = isn;
+      cfg.delayed_ack_ms = 40;
+
+      TCPPeerTestHarness test { "A single segment is ACKed when the timer expires", cfg };
+      test.execute( Connect {} );
+      test.execute( Write { Side::Client, full } );
+      test.execute( ExpectSent { Side::Client, 1 } );
+      test.execute( Deliver { Side::Client } );
+      test.execute( ExpectSent { Side::Server, 0 } );
+      test.execute( Tick { 39 } );
+      test.execute( ExpectSent { Side::Server, 0 } );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectSent { Side::Server, 1 } );
+      test.execute( ExpectSegment { Side::Server }.with_ackno( isn + 1 + full.size() ) );
+      test.execute( ExpectSent { Side::Server, 0 } );
+    }
+
+    {
+      TCPConfig cfg;
+      cfg.fixed_isn = isn;
+      cfg.delayed_ack_ms = 40;
+
+      TCPPeerTestHarness test { "Every second full-sized segment is ACKed at once", cfg };
+      test.execute( Connect {} );
+      test.execute( Write { Side::Client, full + full + full + full } );
+      test.execute( ExpectSent { Side::Client, 4 } );
+      for ( int i = 0; i < 2; ++i ) {
+        test.execute( Deliver { Side::Client }.segment( 0 ) );
+        test.execute( ExpectSent { Side::Server, 0 } );
+        test.execute( Deliver { Side::Client }.segment( 0 ) );
+        test.execute( ExpectSent { Side::Server, 1 } );
+      }
+    }
+
+    {
+      TCPConfig cfg;
+      cfg.fixed_isn = isn;
+      cfg.delayed_ack_ms = 40;
+
+      TCPPeerTestHarness test { "Out-of-order data, and the segment filling the hole, are ACKed at once", cfg };
+      test.execute( Connect {} );
+      test.execute( Write { Side::Client, full + "abc" } );
+      test.execute( ExpectSent { Side::Client, 2 } );
+      test.execute( Deliver { Side::Client }.segment( 1 ) );
+      test.execute( ExpectSent { Side::Server, 1 } );
+      test.execute( Deliver { Side::Client }.segment( 0 ) );
+      test.execute( ExpectSent { Side::Server, 1 } );
+    }
+
+    {
+      TCPConfig cfg;
+      cfg.fixed_isn = isn;
+      cfg.delayed_ack_ms = 40;
+
+      TCPPeerTestHarness test { "A FIN is ACKed at once", cfg };
+      test.execute( Connect {} );
+      test.execute( Write { Side::Client, "abc" }.with_close() );
+      test.execute( ExpectSent { Side::Client, 1 } );
+      test.execute( Deliver { Side::Client } );
+      test.execute( ExpectSent { Side::Server, 1 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
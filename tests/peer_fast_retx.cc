@@ -0,0 +1,125 @@
+#include "peer_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+static constexpr uint64_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+
+int main()
+{
+  try {
+    const string data( 4 * MSS, 'x' );
+
+    {
+      TCPConfig cfg;
+      cfg.fixed_isn = Wrap32 { 1000 };
+      cfg.fast_retransmit = true;
+
+      TCPPeerTestHarness test { "Three duplicate ACKs from the receiver resend the missing segment", cfg };
+      test.execute( Connect {} );
+      test.execute( Write { Side::Client, data } );
+      test.execute( ExpectSent { Side::Client, 4 } );
+
+      // the first segment is lost; the other three are each ACKed with the same ackno at once
+      for ( int i = 0; i < 3; ++i ) {
+        test.execute( Deliver { Side::Client }.segment( 1 ) );
+        test.execute( ExpectSent { Side::Server, 1 } );
+      }
+      test.execute( Deliver { Side::Server } );
+      test.execute( ExpectFastRecovery { Side::Client, true } );
+      test.execute( ExpectSent { Side::Client, 1 } );
+      test.execute( ExpectSegment { Side::Client, 1 }.with_payload_size( MSS ) );
+
+      test.execute( Deliver { Side::Client }.segment( 1 ) );
+      test.execute( Exchange {} );
+      test.execute( ExpectFastRecovery { Side::Client, false } );
+      test.execute( ExpectInFlight { Side::Client, 0 } );
+    }
+
+    {
+      TCPConfig cfg;
+      cfg.fixed_isn = Wrap32 { 1000 };
+
+      TCPPeerTestHarness test { "Without fast_retransmit, duplicate ACKs resend nothing", cfg };
+      test.execute( Connect {} );
+      test.execute( Write { Side::Client, data } );
+      test.execute( ExpectSent { Side::Client, 4 } );
+      for ( int i = 0; i < 3; ++i ) {
+        test.execute( Deliver { Side::Client }.segment( 1 ) );
+        test.execute( ExpectSent { Side::Server, 1 } );
+      }
+      test.execute( Deliver { Side::Server } );
+      test.execute( ExpectFastRecovery { Side::Client, false } );
+      test.execute( ExpectSent { Side::Client, 0 } );
+    }
+
+    {
+      TCPConfig cfg;
+      cfg.fixed_isn = Wrap32 { 1000 };
+      cfg.fast_retransmit = true;
+      cfg.sack = true;
+
+      TCPPeerTestHarness test { "With SACK, both holes are resent before either repair is ACKed", cfg };
+      const uint64_t segment_size = MSS - TCPReceiverMessage::SACK_OPTION_LENGTH; // room left for SACK blocks
+      test.execute( Connect {} );
+      test.execute( Write { Side::Client, string( 6 * segment_size, 'x' ) } );
+      test.execute( ExpectSent { Side::Client, 6 } );
+
+      // segments 0 and 2 are lost; the server SACKs each of the others
+      test.execute( Deliver { Side::Client }.segment( 1 ) );
+      test.execute( ExpectSent { Side::Server, 1 } );
+      for ( int i = 0; i < 3; ++i ) {
+        test.execute( Deliver { Side::Client }.segment( 2 ) );
+        test.execute( ExpectSent { Side::Server, 1 } );
+      }
+      test.execute( Deliver { Side::Server } );
+      test.execute( ExpectFastRecovery { Side::Client, true } );
+      test.execute( ExpectSent { Side::Client, 2 } );
+      test.execute( ExpectSegment { Side::Client, 2 }.with_payload_size( segment_size ) );
+      test.execute( ExpectSegment { Side::Client, 3 }.with_payload_size( segment_size ) );
+
+      test.execute( Deliver { Side::Client }.segment( 3 ) );
+      test.execute( Deliver { Side::Client }.segment( 2 ) );
+      test.execute( Exchange {} );
+      test.execute( ExpectFastRecovery { Side::Client, false } );
+      test.execute( ExpectInFlight { Side::Client, 0 } );
+    }
+
+    {
+      // the server's data segments all carry the ackno and window the client already knows, but they are
+      // not duplicate ACKs: they carry data (RFC 5681 2)
+      TCPConfig cfg;
+      cfg.fixed_isn = Wrap32 { 1000 };
+      cfg.fast_retransmit = true;
+
+      TCPPeerTestHarness test { "Data flowing the other way is not duplicate ACKs", cfg };
+      test.execute( Connect {} );
+      test.execute( Write { Side::Client, data } );
+      test.execute( ExpectSent { Side::Client, 4 } );
+      test.execute( Write { Side::Server, data } );
+      test.execute( ExpectSent { Side::Server, 4 } );
+
+      // the client ACKs each of them, and resends nothing
+      for ( size_t i = 4; i < 8; ++i ) {
+        test.execute( Deliver { Side::Server }.segment( 0 ) );
+        test.execute( ExpectSent { Side::Client, 1 } );
+        test.execute( ExpectSegment { Side::Client, i }.with_payload_size( 0 ) );
+      }
+      test.execute( ExpectFastRecovery { Side::Client, false } );
+
+      test.execute( Exchange {} );
+      test.execute( ExpectInFlight { Side::Client, 0 } );
+      test.execute( ExpectInFlight { Side::Server, 0 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,68 @@
+#include "peer_test_harness.hh"
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    {
+      TCPConfig cfg;
+      cfg.fixed_isn = Wrap32 { 1000 };
+      cfg.nagle = true;
+
+      TCPPeerTestHarness test { "Small writes made during a round trip share one segment", cfg };
+      test.execute( Connect {} );
+      for ( int i = 0; i < 10; ++i ) {
+        test.execute( Write { Side::Client, "r" } );
+        test.execute( ExpectSent { Side::Client, i == 0 ? 1U : 0U } );
+      }
+      test.execute( Deliver { Side::Client } );
+      test.execute( ExpectSent { Side::Server, 1 } );
+      test.execute( Deliver { Side::Server } );
+      test.execute( ExpectSent { Side::Client, 1 } );
+      test.execute( ExpectSegment { Side::Client }.with_payload_size( 9 ) );
+      test.execute( Exchange {} );
+      test.execute( Read { Side::Server, 10 } );
+      test.execute( ExpectBytesRead { Side::Server, 10 } );
+    }
+
+    {
+      TCPConfig cfg;
+      cfg.fixed_isn = Wrap32 { 1000 };
+
+      TCPPeerTestHarness test { "Without Nagle's algorithm, every write is a segment", cfg };
+      test.execute( Connect {} );
+      for ( int i = 0; i < 10; ++i ) {
+        test.execute( Write { Side::Client, "r" } );
+        test.execute( ExpectSent { Side::Client, 1 } );
+      }
+    }
+
+    {
+      TCPConfig cfg;
+      cfg.fixed_isn = Wrap32 { 1000 };
+
+      TCPPeerTestHarness test { "A corked peer sends what was written once uncorked", cfg };
+      test.execute( Connect {} );
+      test.execute( Cork { Side::Client } );
+      test.execute( Write { Side::Client, "GET " } );
+      test.execute( Write { Side::Client, "/index.html" } );
+      test.execute( ExpectSent { Side::Client, 0 } );
+      test.execute( Uncork { Side::Client } );
+      test.execute( ExpectSent { Side::Client, 1 } );
+      test.execute( ExpectSegment { Side::Client }.with_payload_size( 15 ) );
+      test.execute( Exchange {} );
+      test.execute( ExpectInFlight { Side::Client, 0 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,117 @@
+#include "path_mtu_discovery.hh"
+#include "peer_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    {
+      TCPConfig client_cfg;
+      client_cfg.fixed_isn = Wrap32 { 1000 };
+      client_cfg.mss = 1460;
+      TCPConfig server_cfg = client_cfg;
+      server_cfg.mss = 536;
+
+      TCPPeerTestHarness test { "Each side sends segments no larger than the other's MSS option allows",
+                                client_cfg,
+                                server_cfg };
+      test.execute( Push { Side::Client } );
+      test.execute( ExpectSent { Side::Client, 1 } );
+      test.execute( ExpectSegment { Side::Client }.with_syn( true ).with_mss( 1460 ) );
+      test.execute( Deliver { Side::Client } );
+      test.execute( ExpectSent { Side::Server, 1 } );
+      test.execute( ExpectSegment { Side::Server }.with_syn( true ).with_mss( 536 ) );
+      test.execute( Exchange {} );
+      test.execute( ExpectSegmentSize { Side::Client, 536 } );
+      test.execute( ExpectSegmentSize { Side::Server, 536 } );
+
+      test.execute( Write { Side::Client, string( 1000, 'x' ) } );
+      test.execute( ExpectSent { Side::Client, 2 } );
+      test.execute( ExpectSegment { Side::Client, 0 }.with_payload_size( 536 ).with_mss( {} ) );
+      test.execute( ExpectSegment { Side::Client, 1 }.with_payload_size( 464 ) );
+    }
+
+    {
+      // the jumbo-frame MSS on both ends, with a 1500-byte link in between
+      TCPConfig cfg;
+      cfg.fixed_isn = Wrap32 { 1000 };
+      cfg.mss = 8960;
+      cfg.plpmtud = true;
+
+      TCPPeerTestHarness test { "Path MTU discovery finds the largest segment the path carries", cfg };
+      test.execute( PathMaxSegment { 1460 } );
+      test.execute( Connect {} );
+      test.execute( ExpectSegmentSize { Side::Client, TCPConfig::MAX_PAYLOAD_SIZE } );
+
+      // each lost probe is found by a timeout
+      const string data( 20000, 'x' );
+      constexpr int rounds = 40;
+      for ( int i = 0; i < rounds; ++i ) {
+        test.execute( Write { Side::Client, data } );
+        test.execute( Exchange {} );
+        test.execute( Tick { TCPConfig::TIMEOUT_DFLT } );
+        test.execute( Exchange {} );
+        test.execute( Read { Side::Server, data.size() } );
+      }
+
+      test.execute( ExpectSegmentSize { Side::Client }
+                      .at_least( 1460 - PathMTUDiscovery::SEARCH_GRANULARITY + 1 )
+                      .at_most( 1460 ) );
+      test.execute( ExpectBytesRead { Side::Server, rounds * data.size() } );
+      test.execute( ExpectInFlight { Side::Client, 0 } );
+
+      // the search is over: every segment now gets through
+      test.execute( Write { Side::Client, data } );
+      test.execute( Exchange {} );
+      test.execute( ExpectInFlight { Side::Client, 0 } );
+    }
+
+    {
+      TCPConfig cfg;
+      cfg.fixed_isn = Wrap32 { 1000 };
+      cfg.mss = 8960;
+      cfg.plpmtud = true;
+      cfg.sack = true;
+
+      TCPPeerTestHarness test { "Segments leave room for SACK blocks on a path discovered without them", cfg };
+      test.execute( PathMaxSegment { 1460 } );
+      test.execute( Connect {} );
+
+      const string data( 20000, 'x' );
+      for ( int i = 0; i < 40; ++i ) {
+        test.execute( Write { Side::Client, data } );
+        test.execute( Exchange {} );
+        test.execute( Tick { TCPConfig::TIMEOUT_DFLT } );
+        test.execute( Exchange {} );
+        test.execute( Read { Side::Server, data.size() } );
+      }
+      const uint64_t room = TCPReceiverMessage::SACK_OPTION_LENGTH;
+      test.execute( ExpectSegmentSize { Side::Client }
+                      .at_least( 1460 - room - PathMTUDiscovery::SEARCH_GRANULARITY + 1 )
+                      .at_most( 1460 - room ) );
+
+      // the client's full-sized segments carry SACK blocks once the server's data arrives with a hole,
+      // and still get through
+      test.execute( Write { Side::Server, string( 3000, 'y' ) } );
+      test.execute( ExpectSent { Side::Server, 4 } );
+      test.execute( Deliver { Side::Server }.segment( 1 ) );
+      test.execute( Write { Side::Client, data } );
+      test.execute( Exchange {} );
+      test.execute( ExpectInFlight { Side::Client, 0 } );
+      test.execute( Read { Side::Server, data.size() } );
+      test.execute( ExpectBytesRead { Side::Server, 41 * data.size() } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,107 @@
+#include "peer_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+// One simulated round trip: the client sends what the window allows, the server's application reads up to
+// `read_per_rtt` bytes, the acknowledgments come back, and 10 ms pass
+static void simulate_rtt( TCPPeerTestHarness& test, uint64_t read_per_rtt )
+{
+  test.execute( Write { Side::Client, "" }.filling() );
+  test.execute( Exchange {} );
+  test.execute( Read { Side::Server, read_per_rtt } );
+  test.execute( Exchange {} );
+  test.execute( Tick { 10 } );
+  test.execute( Exchange {} );
+}
+
+int main()
+{
+  try {
+    {
+      TCPConfig cfg;
+      cfg.rt_timeout = 10; // recover a lost zero-window probe within a round trip
+      cfg.window_scale = true;
+      cfg.send_capacity = 4 << 20;
+
+      TCPPeerTestHarness test { "Without autotuning, the receive buffer stays at recv_capacity", cfg };
+      test.execute( Connect {} );
+      for ( int i = 0; i < 20; ++i ) {
+        simulate_rtt( test, UINT64_MAX );
+      }
+      test.execute( ExpectRecvCapacity { Side::Server, TCPConfig::DEFAULT_CAPACITY } );
+    }
+
+    {
+      TCPConfig cfg;
+      cfg.rt_timeout = 10;
+      cfg.window_scale = true;
+      cfg.send_capacity = 4 << 20;
+
+      TCPPeerTestHarness test { "Without autotuning, reading sends no window update", cfg };
+      test.execute( Connect {} );
+      test.execute( Write { Side::Client, string( 4 * TCPConfig::MAX_PAYLOAD_SIZE, 'x' ) } );
+      test.execute( Exchange {} );
+      test.execute( Read { Side::Server, UINT64_MAX } );
+      test.execute( ExpectSent { Side::Server, 0 } );
+    }
+
+    {
+      TCPConfig cfg;
+      cfg.rt_timeout = 10;
+      cfg.window_scale = true;
+      cfg.send_capacity = 4 << 20;
+      cfg.recv_autotune = true;
+      cfg.recv_capacity_min = 16000;
+      cfg.recv_capacity_max = 1 << 20;
+
+      TCPPeerTestHarness test { "With autotuning, reading a full segment sends a window update", cfg };
+      test.execute( Connect {} );
+      test.execute( Write { Side::Client, string( 4 * TCPConfig::MAX_PAYLOAD_SIZE, 'x' ) } );
+      test.execute( Exchange {} );
+      test.execute( Read { Side::Server, TCPConfig::MAX_PAYLOAD_SIZE - 1 } );
+      test.execute( ExpectSent { Side::Server, 0 } );
+      test.execute( Read { Side::Server, 1 } );
+      test.execute( ExpectSent { Side::Server, 1 } );
+    }
+
+    {
+      TCPConfig cfg;
+      cfg.rt_timeout = 10;
+      cfg.window_scale = true;
+      cfg.send_capacity = 4 << 20;
+      cfg.recv_autotune = true;
+      cfg.recv_capacity_min = 16000;
+      cfg.recv_capacity_max = 1 << 20;
+
+      TCPPeerTestHarness test { "The receive buffer follows the application's read rate", cfg };
+      test.execute( Connect {} );
+
+      // an application that keeps up with the sender lets the buffer grow to the maximum
+      for ( int i = 0; i < 20; ++i ) {
+        simulate_rtt( test, UINT64_MAX );
+      }
+      test.execute( ExpectRecvRTT { Side::Server, true } );
+      test.execute( ExpectRecvCapacity { Side::Server, 1 << 20 } );
+      // and the larger buffer let the sender go faster
+      test.execute( ExpectBytesRead { Side::Server }.at_least( 20 * TCPConfig::DEFAULT_CAPACITY + 1 ) );
+
+      // a slow application makes it shrink again, but never below what was already advertised
+      for ( int i = 0; i < 200; ++i ) {
+        simulate_rtt( test, 20000 );
+        test.execute( ExpectWindowKept { Side::Server } );
+      }
+      test.execute( ExpectRecvCapacity { Side::Server }.at_least( 40000 ).at_most( 100000 ) );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,520 @@
+#pragma once
+
+#include "common.hh"
+#include "segment_round_trip.hh"
+#include "tcp_config.hh"
+#include "tcp_peer.hh"
+
+#include <cstddef>
+#include <optional>
+#include <sstream>
+#include <utility>
+#include <deque>
+
+enum class Side
+{
+  Client,
+  Server,
+};
+
+static std::string to_string( Side side )
+{
+  return side == Side::Client ? "client" : "server";
+}
+
+// Two peers and the segments each has sent that haven't been delivered yet
+struct PeerPair
+{
+  TCPPeer client;
+  TCPPeer server;
+  std::deque<TCPSegment> from_client {};
+  std::deque<TCPSegment> from_server {};
+  std::optional<size_t> path_max_segment {}; // segments with more option and payload bytes are dropped on the way
+
+  TCPPeer& peer( Side side ) { return side == Side::Client ? client : server; }
+  TCPPeer& other( Side side ) { return side == Side::Client ? server : client; }
+  std::deque<TCPSegment>& sent( Side side ) { return side == Side::Client ? from_client : from_server; }
+
+  // Put everything `side` has to send on the wire; returns how many segments that was
+  size_t collect( Side side )
+  {
+    size_t count = 0;
+    while ( auto seg = peer( side ).maybe_send() ) {
+      sent( side ).push_back( round_trip( std::move( seg.value() ) ) );
+      ++count;
+    }
+    return count;
+  }
+
+  void deliver( Side side, size_t index )
+  {
+    auto& segments = sent( side );
+    if ( index >= segments.size() ) {
+      throw std::runtime_error( "no segment #" + std::to_string( index ) + " from the " + to_string( side ) );
+    }
+    TCPSegment seg = std::move( segments[index] );
+    segments.erase( segments.begin() + static_cast<ptrdiff_t>( index ) );
+    if ( path_max_segment.has_value()
+         and seg.options_length() + seg.sender_message.payload.size() > path_max_segment.value() ) {
+      return;
+    }
+    other( side ).receive( std::move( seg ) );
+  }
+
+  // Deliver everything either side sends until both are quiet
+  void exchange()
+  {
+    collect( Side::Client );
+    collect( Side::Server );
+    while ( not from_client.empty() or not from_server.empty() ) {
+      while ( not from_client.empty() ) {
+        deliver( Side::Client, 0 );
+      }
+      while ( not from_server.empty() ) {
+        deliver( Side::Server, 0 );
+      }
+      collect( Side::Client );
+      collect( Side::Server );
+    }
+  }
+};
+
+struct Connect : public Action<PeerPair>
+{
+  std::string description() const override { return "client connects, segments exchanged until quiet"; }
+  void execute( PeerPair& peers ) const override
+  {
+    peers.client.push();
+    peers.exchange();
+  }
+};
+
+struct Exchange : public Action<PeerPair>
+{
+  std::string description() const override { return "segments exchanged until quiet"; }
+  void execute( PeerPair& peers ) const override { peers.exchange(); }
+};
+
+// The path between the peers drops segments with more bytes of TCP options and payload than this (its MTU less
+// the IP and fixed TCP headers), without telling anyone
+struct PathMaxSegment : public Action<PeerPair>
+{
+  size_t max_;
+
+  explicit PathMaxSegment( size_t max ) : max_( max ) {}
+  std::string description() const override
+  {
+    return "the path drops segments with more than " + std::to_string( max_ ) + " bytes of options and payload";
+  }
+  void execute( PeerPair& peers ) const override { peers.path_max_segment = max_; }
+};
+
+struct Push : public Action<PeerPair>
+{
+  Side side_;
+
+  explicit Push( Side side ) : side_( side ) {}
+  std::string description() const override { return "push " + to_string( side_ ) + "'s TCPSender"; }
+  void execute( PeerPair& peers ) const override { peers.peer( side_ ).push(); }
+};
+
+// Hold back segments smaller than a full one until Uncork
+struct Cork : public Action<PeerPair>
+{
+  Side side_;
+
+  explicit Cork( Side side ) : side_( side ) {}
+  std::string description() const override { return to_string( side_ ) + " corks"; }
+  void execute( PeerPair& peers ) const override { peers.peer( side_ ).cork(); }
+};
+
+// Send what was written, small segments or not, and stop holding them back
+struct Uncork : public Action<PeerPair>
+{
+  Side side_;
+
+  explicit Uncork( Side side ) : side_( side ) {}
+  std::string description() const override { return to_string( side_ ) + " uncorks"; }
+  void execute( PeerPair& peers ) const override { peers.peer( side_ ).uncork(); }
+};
+
+struct Write : public Action<PeerPair>
+{
+  Side side_;
+  std::string data_;
+  bool fill_ {};
+  bool close_ {};
+
+  Write( Side side, std::string data ) : side_( side ), data_( std::move( data ) ) {}
+
+  // Fill whatever room the outbound stream has left
+  Write& filling()
+  {
+    fill_ = true;
+    return *this;
+  }
+
+  Write& with_close()
+  {
+    close_ = true;
+    return *this;
+  }
+
+  std::string description() const override
+  {
+    std::ostringstream desc;
+    desc << to_string( side_ ) << " writes ";
+    if ( fill_ ) {
+      desc << "until its outbound stream is full";
+    } else {
+      desc << "\"" << Printer::prettify( data_ ) << "\"";
+    }
+    if ( close_ ) {
+      desc << " and closes";
+    }
+    return desc.str();
+  }
+
+  void execute( PeerPair& peers ) const override
+  {
+    Writer& writer = peers.peer( side_ ).outbound_writer();
+    writer.push( fill_ ? std::string( writer.available_capacity(), 'x' ) : data_ );
+    if ( close_ ) {
+      writer.close();
+    }
+  }
+};
+
+struct Read : public Action<PeerPair>
+{
+  Side side_;
+  uint64_t len_;
+
+  Read( Side side, uint64_t len ) : side_( side ), len_( len ) {}
+  std::string description() const override
+  {
+    return to_string( side_ ) + " reads up to " + std::to_string( len_ ) + " bytes";
+  }
+  void execute( PeerPair& peers ) const override { peers.peer( side_ ).inbound_reader().pop( len_ ); }
+};
+
+struct Tick : public Action<PeerPair>
+{
+  uint64_t ms_;
+
+  explicit Tick( uint64_t ms ) : ms_( ms ) {}
+  std::string description() const override { return std::to_string( ms_ ) + " ms pass"; }
+  void execute( PeerPair& peers ) const override
+  {
+    peers.client.tick( ms_ );
+    peers.server.tick( ms_ );
+  }
+};
+
+// Put what a peer has to send on the wire, without delivering it
+struct Collect : public Action<PeerPair>
+{
+  Side side_;
+
+  explicit Collect( Side side ) : side_( side ) {}
+  std::string description() const override { return to_string( side_ ) + " sends what it can"; }
+  void execute( PeerPair& peers ) const override { peers.collect( side_ ); }
+};
+
+// Deliver the segments a peer has on the wire, or only one of them
+struct Deliver : public Action<PeerPair>
+{
+  Side side_;
+  std::optional<size_t> index_ {};
+
+  explicit Deliver( Side side ) : side_( side ) {}
+
+  Deliver& segment( size_t index )
+  {
+    index_ = index;
+    return *this;
+  }
+
+  std::string description() const override
+  {
+    if ( index_.has_value() ) {
+      return "deliver segment #" + std::to_string( index_.value() ) + " from the " + to_string( side_ );
+    }
+    return "deliver every segment from the " + to_string( side_ );
+  }
+
+  void execute( PeerPair& peers ) const override
+  {
+    if ( index_.has_value() ) {
+      peers.deliver( side_, index_.value() );
+      return;
+    }
+    while ( not peers.sent( side_ ).empty() ) {
+      peers.deliver( side_, 0 );
+    }
+  }
+};
+
+// The peer puts exactly `count` new segments on the wire
+struct ExpectSent : public Expectation<PeerPair>
+{
+  Side side_;
+  size_t count_;
+
+  ExpectSent( Side side, size_t count ) : side_( side ), count_( count ) {}
+  std::string description() const override
+  {
+    return to_string( side_ ) + " sends " + std::to_string( count_ ) + " segment(s)";
+  }
+  void execute( PeerPair& peers ) const override
+  {
+    const size_t sent = peers.collect( side_ );
+    if ( sent != count_ ) {
+      throw ExpectationViolation( "segments sent by the " + to_string( side_ ), count_, sent );
+    }
+  }
+};
+
+// Inspect a segment on the wire
+struct ExpectSegment : public Expectation<PeerPair>
+{
+  Side side_;
+  size_t index_;
+  std::optional<bool> syn_ {};
+  std::optional<Wrap32> ackno_ {};
+  std::optional<uint16_t> window_ {};
+  std::optional<std::optional<uint8_t>> window_scale_ {};
+  std::optional<size_t> payload_size_ {};
+  std::optional<std::optional<uint16_t>> mss_ {};
+
+  explicit ExpectSegment( Side side, size_t index = 0 ) : side_( side ), index_( index ) {}
+
+  ExpectSegment& with_syn( bool syn )
+  {
+    syn_ = syn;
+    return *this;
+  }
+
+  ExpectSegment& with_ackno( Wrap32 ackno )
+  {
+    ackno_ = ackno;
+    return *this;
+  }
+
+  ExpectSegment& with_window( uint16_t window )
+  {
+    window_ = window;
+    return *this;
+  }
+
+  ExpectSegment& with_window_scale( std::optional<uint8_t> shift )
+  {
+    window_scale_ = shift;
+    return *this;
+  }
+
+  ExpectSegment& with_payload_size( size_t size )
+  {
+    payload_size_ = size;
+    return *this;
+  }
+
+  ExpectSegment& with_mss( std::optional<uint16_t> mss )
+  {
+    mss_ = mss;
+    return *this;
+  }
+
+  std::string description() const override
+  {
+    std::ostringstream desc;
+    desc << to_string( side_ ) << "'s segment #" << index_ << " has";
+    if ( syn_.has_value() ) {
+      desc << ( syn_.value() ? " +SYN" : " (no SYN)" );
+    }
+    if ( ackno_.has_value() ) {
+      desc << " ackno=" << ackno_.value();
+    }
+    if ( window_.has_value() ) {
+      desc << " win=" << window_.value();
+    }
+    if ( window_scale_.has_value() ) {
+      desc << " wscale=" << to_string( window_scale_.value() );
+    }
+    if ( payload_size_.has_value() ) {
+      desc << " payload_len=" << payload_size_.value();
+    }
+    if ( mss_.has_value() ) {
+      desc << " mss=" << to_string( mss_.value() );
+    }
+    return desc.str();
+  }
+
+  void execute( PeerPair& peers ) const override
+  {
+    const auto& segments = peers.sent( side_ );
+    if ( index_ >= segments.size() ) {
+      throw ExpectationViolation( "expected a segment #" + std::to_string( index_ ) + " from the "
+                                  + to_string( side_ ) + ", but only " + std::to_string( segments.size() )
+                                  + " are on the wire" );
+    }
+    const TCPSegment& seg = segments[index_];
+
+    if ( syn_.has_value() and seg.sender_message.SYN != syn_.value() ) {
+      throw ExpectationViolation( "SYN flag", syn_.value(), seg.sender_message.SYN );
+    }
+    if ( ackno_.has_value() and seg.receiver_message.ackno != ackno_ ) {
+      throw ExpectationViolation( "ackno", ackno_, seg.receiver_message.ackno );
+    }
+    if ( window_.has_value() and seg.receiver_message.window_size != window_.value() ) {
+      throw ExpectationViolation( "window_size", window_.value(), seg.receiver_message.window_size );
+    }
+    if ( window_scale_.has_value() and seg.receiver_message.window_scale != window_scale_.value() ) {
+      throw ExpectationViolation( "window_scale", window_scale_.value(), seg.receiver_message.window_scale );
+    }
+    if ( payload_size_.has_value() and seg.sender_message.payload.size() != payload_size_.value() ) {
+      throw ExpectationViolation( "payload_size", payload_size_.value(), seg.sender_message.payload.size() );
+    }
+    if ( mss_.has_value() and seg.receiver_message.mss != mss_.value() ) {
+      throw ExpectationViolation( "mss", mss_.value(), seg.receiver_message.mss );
+    }
+  }
+};
+
+// A quantity of one peer, exactly or within bounds
+struct ExpectPeerNumber : public Expectation<PeerPair>
+{
+  Side side_;
+  uint64_t min_ {};
+  uint64_t max_ { UINT64_MAX };
+
+  explicit ExpectPeerNumber( Side side ) : side_( side ) {}
+  ExpectPeerNumber( Side side, uint64_t value ) : side_( side ), min_( value ), max_( value ) {}
+
+  virtual std::string name() const = 0;
+  virtual uint64_t value( PeerPair& peers ) const = 0;
+
+  std::string description() const override
+  {
+    const std::string prefix = to_string( side_ ) + "'s " + name();
+    if ( min_ == max_ ) {
+      return prefix + " = " + std::to_string( min_ );
+    }
+    return prefix + " in [" + std::to_string( min_ ) + ", "
+           + ( max_ == UINT64_MAX ? "inf" : std::to_string( max_ ) ) + "]";
+  }
+
+  void execute( PeerPair& peers ) const override
+  {
+    const uint64_t actual = value( peers );
+    if ( min_ == max_ and actual != min_ ) {
+      throw ExpectationViolation( to_string( side_ ) + "'s " + name(), min_, actual );
+    }
+    if ( actual < min_ or actual > max_ ) {
+      throw ExpectationViolation( "The object should have had " + description() + ", but instead it was "
+                                  + std::to_string( actual ) + "." );
+    }
+  }
+};
+
+template<class Derived>
+struct ExpectPeerBounds : public ExpectPeerNumber
+{
+  using ExpectPeerNumber::ExpectPeerNumber;
+
+  Derived& at_least( uint64_t value )
+  {
+    min_ = value;
+    return static_cast<Derived&>( *this );
+  }
+
+  Derived& at_most( uint64_t value )
+  {
+    max_ = value;
+    return static_cast<Derived&>( *this );
+  }
+};
+
+struct ExpectInFlight : public ExpectPeerBounds<ExpectInFlight>
+{
+  using ExpectPeerBounds::ExpectPeerBounds;
+  std::string name() const override { return "sequence_numbers_in_flight"; }
+  uint64_t value( PeerPair& peers ) const override
+  {
+    return peers.peer( side_ ).sender().sequence_numbers_in_flight();
+  }
+};
+
+struct ExpectSegmentSize : public ExpectPeerBounds<ExpectSegmentSize>
+{
+  using ExpectPeerBounds::ExpectPeerBounds;
+  std::string name() const override { return "segment size"; }
+  uint64_t value( PeerPair& peers ) const override { return peers.peer( side_ ).sender().segment_size(); }
+};
+
+struct ExpectRecvCapacity : public ExpectPeerBounds<ExpectRecvCapacity>
+{
+  using ExpectPeerBounds::ExpectPeerBounds;
+  std::string name() const override { return "inbound capacity"; }
+  uint64_t value( PeerPair& peers ) const override { return peers.peer( side_ ).inbound_reader().capacity(); }
+};
+
+struct ExpectBytesRead : public ExpectPeerBounds<ExpectBytesRead>
+{
+  using ExpectPeerBounds::ExpectPeerBounds;
+  std::string name() const override { return "bytes read"; }
+  uint64_t value( PeerPair& peers ) const override { return peers.peer( side_ ).inbound_reader().bytes_popped(); }
+};
+
+struct ExpectRecvRTT : public ExpectBool<PeerPair>
+{
+  Side side_;
+
+  ExpectRecvRTT( Side side, bool value ) : ExpectBool( value ), side_( side ) {}
+  std::string name() const override { return to_string( side_ ) + " has a receiver-side RTT estimate"; }
+  bool value( PeerPair& peers ) const override
+  {
+    const auto& tuner = peers.peer( side_ ).recv_tuner();
+    return tuner.has_value() and tuner->rtt_ms().has_value();
+  }
+};
+
+struct ExpectFastRecovery : public ExpectBool<PeerPair>
+{
+  Side side_;
+
+  ExpectFastRecovery( Side side, bool value ) : ExpectBool( value ), side_( side ) {}
+  std::string name() const override { return to_string( side_ ) + " is in fast recovery"; }
+  bool value( PeerPair& peers ) const override { return peers.peer( side_ ).sender().in_fast_recovery(); }
+};
+
+// The peer never takes back window it advertised: its inbound stream has room up to the edge it announced
+struct ExpectWindowKept : public Expectation<PeerPair>
+{
+  Side side_;
+
+  explicit ExpectWindowKept( Side side ) : side_( side ) {}
+  std::string description() const override { return to_string( side_ ) + " keeps the window it advertised"; }
+  void execute( PeerPair& peers ) const override
+  {
+    TCPPeer& peer = peers.peer( side_ );
+    const uint64_t edge = peer.inbound_reader().bytes_popped() + peer.inbound_reader().capacity();
+    if ( edge < peer.advertised_window_edge() ) {
+      throw ExpectationViolation( "The " + to_string( side_ ) + " advertised a window up to stream index "
+                                  + std::to_string( peer.advertised_window_edge() )
+                                  + ", but now has room only up to " + std::to_string( edge ) + "." );
+    }
+  }
+};
+
+class TCPPeerTestHarness : public TestHarness<PeerPair>
+{
+public:
+  TCPPeerTestHarness( std::string name, const TCPConfig& client_config, const TCPConfig& server_config )
+    : TestHarness( move( name ), "client and server", { TCPPeer { client_config }, TCPPeer { server_config } } )
+  {}
+
+  TCPPeerTestHarness( std::string name, const TCPConfig& config )
+    : TCPPeerTestHarness( move( name ), config, config )
+  {}
+};
@@ -0,0 +1,108 @@
+#include "peer_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    constexpr size_t MiB = 1 << 20;
+
+    {
+      TCPConfig cfg;
+      cfg.window_scale = true;
+      cfg.recv_capacity = 4 * MiB;
+      cfg.send_capacity = 4 * MiB;
+
+      TCPPeerTestHarness test { "SYN offers the shift covering the receive capacity", cfg };
+      test.execute( Push { Side::Client } );
+      test.execute( ExpectSent { Side::Client, 1 } );
+      // the window on the SYN itself is never scaled
+      test.execute(
+        ExpectSegment { Side::Client }.with_syn( true ).with_window_scale( 7 ).with_window( UINT16_MAX ) );
+    }
+
+    {
+      TCPConfig client_cfg;
+      client_cfg.recv_capacity = 4 * MiB;
+      client_cfg.send_capacity = 4 * MiB;
+      TCPConfig server_cfg = client_cfg;
+      server_cfg.window_scale = true;
+
+      TCPPeerTestHarness test { "No window scaling offered to a peer that did not offer it",
+                                client_cfg,
+                                server_cfg };
+      test.execute( Push { Side::Client } );
+      test.execute( ExpectSent { Side::Client, 1 } );
+      test.execute( ExpectSegment { Side::Client }.with_window_scale( nullopt ) );
+      test.execute( Deliver { Side::Client } );
+      test.execute( ExpectSent { Side::Server, 1 } );
+      test.execute( ExpectSegment { Side::Server }.with_syn( true ).with_window_scale( nullopt ) );
+    }
+
+    // after the handshake and a first ACK (the window on the SYN is unscaled), the client fills the window
+    {
+      TCPConfig cfg;
+      cfg.window_scale = true;
+      cfg.recv_capacity = 4 * MiB;
+      cfg.send_capacity = 4 * MiB;
+
+      TCPPeerTestHarness test { "Both sides offer scaling: the window goes beyond 64 KiB", cfg };
+      test.execute( Connect {} );
+      test.execute( Write { Side::Client, "x" } );
+      test.execute( Exchange {} );
+      test.execute( Write { Side::Client, string( MiB, 'x' ) } );
+      test.execute( Collect { Side::Client } );
+      test.execute( ExpectInFlight { Side::Client, MiB } );
+    }
+
+    {
+      TCPConfig client_cfg;
+      client_cfg.window_scale = true;
+      client_cfg.recv_capacity = 4 * MiB;
+      client_cfg.send_capacity = 4 * MiB;
+      TCPConfig server_cfg = client_cfg;
+      server_cfg.window_scale = false;
+
+      TCPPeerTestHarness test { "Only one side offers scaling: the window stays within 64 KiB",
+                                client_cfg,
+                                server_cfg };
+      test.execute( Connect {} );
+      test.execute( Write { Side::Client, "x" } );
+      test.execute( Exchange {} );
+      test.execute( Write { Side::Client, string( MiB, 'x' ) } );
+      test.execute( Collect { Side::Client } );
+      test.execute( ExpectInFlight { Side::Client, UINT16_MAX } );
+    }
+
+    {
+      TCPConfig client_cfg;
+      client_cfg.window_scale = true;
+      client_cfg.recv_capacity = 4 * MiB;
+      client_cfg.send_capacity = 4 * MiB;
+      TCPConfig server_cfg = client_cfg;
+      server_cfg.recv_capacity = 200000;
+      server_cfg.send_capacity = 200000;
+
+      TCPPeerTestHarness test { "The window is advertised in units of the negotiated shift",
+                                client_cfg,
+                                server_cfg };
+      test.execute( Connect {} );
+      test.execute( Write { Side::Client, string( 10, 'x' ) } );
+      test.execute( ExpectSent { Side::Client, 1 } );
+      test.execute( Deliver { Side::Client } );
+      test.execute( ExpectSent { Side::Server, 1 } );
+      test.execute( ExpectSegment { Side::Server }.with_window( ( 200000 - 10 ) >> 2 ) );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
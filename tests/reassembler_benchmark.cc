@@ -0,0 +1,234 @@
+#include "allocation_counter.hh"
+#include "reassembler.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+/*
+ * Benchmark suite for the Reassembler under adversarial delivery patterns. Each pattern is
+ * generated up front as a list of segments confined to successive capacity-sized windows, so
+ * every byte is delivered no matter how the engine holds data. Prints one JSON array with
+ * ns per stream byte, the peak of bytes_pending() and heap allocations for each pattern.
+ */
+
+namespace {
+
+struct Segment
+{
+  uint64_t index;
+  string data;
+  bool last;
+};
+
+struct Pattern
+{
+  string name;
+  size_t capacity;
+  size_t length;
+  // append the segments for the window [begin, end) of `data`
+  function<void( const string& data, size_t begin, size_t end, default_random_engine& rd, vector<Segment>& out )>
+    window;
+};
+
+constexpr size_t segment_size = 1460;
+
+void add( const string& data, size_t begin, size_t end, vector<Segment>& out )
+{
+  end = min( end, data.size() );
+  if ( begin < end ) {
+    out.push_back( { begin, data.substr( begin, end - begin ), end == data.size() } );
+  }
+}
+
+// every segment of the window, in order
+void cover( const string& data, size_t begin, size_t end, vector<Segment>& out )
+{
+  for ( size_t i = begin; i < end; i += segment_size ) {
+    add( data, i, min( i + segment_size, end ), out );
+  }
+}
+
+vector<Pattern> patterns()
+{
+  return {
+    { "in_order",
+      65000,
+      1 << 22,
+      []( const string& data, size_t begin, size_t end, default_random_engine&, vector<Segment>& out ) {
+        cover( data, begin, end, out );
+      } },
+
+    { "triple_overlap",
+      1500,
+      1 << 22,
+      []( const string& data, size_t begin, size_t end, default_random_engine&, vector<Segment>& out ) {
+        add( data, begin + 2, begin + 2 * ( end - begin ), out );
+        add( data, begin, begin + 2 * ( end - begin ), out );
+        add( data, begin + 1, begin + 2 * ( end - begin ), out );
+      } },
+
+    { "reverse_order",
+      65000,
+      1 << 22,
+      []( const string& data, size_t begin, size_t end, default_random_engine&, vector<Segment>& out ) {
+        vector<Segment> window;
+        cover( data, begin, end, window );
+        out.insert( out.end(), make_move_iterator( window.rbegin() ), make_move_iterator( window.rend() ) );
+      } },
+
+    { "tiny_holes",
+      16000,
+      1 << 19,
+      []( const string& data, size_t begin, size_t end, default_random_engine& rd, vector<Segment>& out ) {
+        // every odd byte in random order, leaving a one-byte hole between each, then the even bytes
+        vector<size_t> odd;
+        for ( size_t i = begin + 1; i < end; i += 2 ) {
+          odd.push_back( i );
+        }
+        shuffle( odd.begin(), odd.end(), rd );
+        for ( const size_t i : odd ) {
+          add( data, i, i + 1, out );
+        }
+        for ( size_t i = begin; i < end; i += 2 ) {
+          add( data, i, i + 1, out );
+        }
+      } },
+
+    { "random_overlap",
+      65000,
+      1 << 22,
+      []( const string& data, size_t begin, size_t end, default_random_engine& rd, vector<Segment>& out ) {
+        uniform_int_distribution<size_t> start { begin, end - 1 };
+        uniform_int_distribution<size_t> len { 1, 2 * segment_size };
+        for ( size_t i = 0; i < 4 * ( end - begin ) / segment_size; ++i ) {
+          const size_t first = start( rd );
+          add( data, first, min( first + len( rd ), end ), out );
+        }
+        cover( data, begin, end, out );
+      } },
+
+    { "duplicate_flood",
+      65000,
+      1 << 21,
+      []( const string& data, size_t begin, size_t end, default_random_engine&, vector<Segment>& out ) {
+        // each segment four times, back to front so the copies must be recognised as held
+        vector<Segment> window;
+        cover( data, begin, end, window );
+        for ( auto it = window.rbegin(); it != window.rend(); ++it ) {
+          for ( int copy = 0; copy < 4; ++copy ) {
+            out.push_back( *it );
+          }
+        }
+      } },
+
+    { "window_edge",
+      65000,
+      1 << 22,
+      []( const string& data, size_t begin, size_t end, default_random_engine& rd, vector<Segment>& out ) {
+        // segments that run far past the window and must be truncated, then the window itself
+        uniform_int_distribution<size_t> start { begin + 1, end - 1 };
+        for ( size_t i = 0; i < 8; ++i ) {
+          const size_t first = start( rd );
+          add( data, first, first + 3 * ( end - begin ), out );
+        }
+        cover( data, begin, end, out );
+      } },
+  };
+}
+
+string run( const Pattern& pattern )
+{
+  default_random_engine rd { 1370 };
+
+  const string data = [&] {
+    uniform_int_distribution<char> ud;
+    string ret;
+    ret.reserve( pattern.length );
+    for ( size_t i = 0; i < pattern.length; ++i ) {
+      ret += ud( rd );
+    }
+    return ret;
+  }();
+
+  vector<Segment> segments;
+  for ( size_t i = 0; i < data.size(); i += pattern.capacity ) {
+    pattern.window( data, i, min( i + pattern.capacity, data.size() ), rd, segments );
+  }
+
+  ByteStream stream { pattern.capacity };
+  Reassembler reassembler;
+  string output;
+  output.reserve( data.size() );
+  uint64_t peak_pending = 0;
+
+  const uint64_t allocs_before = allocations.load();
+  const auto start_time = steady_clock::now();
+
+  for ( auto& seg : segments ) {
+    reassembler.insert( seg.index, move( seg.data ), seg.last, stream.writer() );
+    peak_pending = max( peak_pending, reassembler.bytes_pending() );
+
+    while ( stream.reader().bytes_buffered() ) {
+      const auto peeked = stream.reader().peek();
+      output += peeked;
+      stream.reader().pop( peeked.size() );
+    }
+  }
+
+  const auto stop_time = steady_clock::now();
+  const uint64_t allocs = allocations.load() - allocs_before;
+
+  if ( not stream.reader().is_finished() ) {
+    throw runtime_error( pattern.name + ": Reassembler did not close ByteStream when finished" );
+  }
+  if ( output != data ) {
+    throw runtime_error( pattern.name + ": mismatch between data written and read" );
+  }
+
+  const double seconds = duration_cast<duration<double>>( stop_time - start_time ).count();
+
+  ostringstream out;
+  out << fixed << setprecision( 3 );
+  out << R"({"pattern": ")" << pattern.name << R"(", "capacity": )" << pattern.capacity << R"(, "bytes": )"
+      << data.size() << R"(, "inserts": )" << segments.size() << R"(, "ns_per_byte": )"
+      << seconds * 1e9 / static_cast<double>( data.size() ) << R"(, "peak_bytes_pending": )" << peak_pending
+      << R"(, "allocations": )" << allocs << "}";
+  return out.str();
+}
+
+void program_body()
+{
+  const auto all = patterns();
+
+  cout << "[\n";
+  for ( size_t i = 0; i < all.size(); ++i ) {
+    cout << "  " << run( all[i] ) << ( i + 1 < all.size() ? ",\n" : "\n" );
+  }
+  cout << "]\n";
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,126 @@
+#include "reassembler_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+static void expect_budget( const ReassemblyBudget& budget, uint64_t held, uint64_t pruned )
+{
+  if ( budget.bytes_held() != held or budget.bytes_pruned() != pruned ) {
+    throw runtime_error( "budget has " + to_string( budget.bytes_held() ) + " bytes held and "
+                         + to_string( budget.bytes_pruned() ) + " pruned, expected " + to_string( held ) + " and "
+                         + to_string( pruned ) );
+  }
+}
+
+int main()
+{
+  try {
+    {
+      auto budget = make_shared<ReassemblyBudget>( 4 );
+      ReassemblerTestHarness test { "budget truncates held data", 65000, budget };
+
+      test.execute( Insert { "bcdefg", 1 } );
+      test.execute( BytesPending( 4 ) );
+      test.execute( BytesPruned( 2 ) );
+      expect_budget( *budget, 4, 2 );
+
+      test.execute( Insert { "a", 0 } );
+      test.execute( BytesPushed( 5 ) );
+      test.execute( ReadAll( "abcde" ) );
+      test.execute( BytesPending( 0 ) );
+      expect_budget( *budget, 0, 2 );
+
+      test.execute( Insert { "fg", 5 }.is_last() );
+      test.execute( ReadAll( "fg" ) );
+      test.execute( IsFinished { true } );
+    }
+
+    {
+      auto budget = make_shared<ReassemblyBudget>( 4 );
+      ReassemblerTestHarness test { "highest offset dropped first", 65000, budget };
+
+      test.execute( Insert { "ij", 8 } );
+      test.execute( Insert { "cd", 2 } );
+      test.execute( BytesPending( 4 ) );
+      test.execute( Insert { "ef", 4 } );
+      test.execute( BytesPending( 4 ) );
+      test.execute( BytesPruned( 2 ) );
+
+      test.execute( Insert { "ab", 0 } );
+      test.execute( ReadAll( "abcdef" ) );
+      test.execute( BytesPending( 0 ) );
+      expect_budget( *budget, 0, 2 );
+    }
+
+    {
+      auto budget = make_shared<ReassemblyBudget>( 4 );
+      ReassemblerTestHarness test { "in-order data is not charged", 65000, budget };
+
+      test.execute( Insert { "abcdefgh", 0 } );
+      test.execute( ReadAll( "abcdefgh" ) );
+      test.execute( BytesPruned( 0 ) );
+      expect_budget( *budget, 0, 0 );
+    }
+
+    {
+      auto budget = make_shared<ReassemblyBudget>( 4000 );
+      ReassemblerTestHarness test { "a small slice does not pin a large payload", 65000, budget };
+
+      // hold [1, 1000) but for a one-byte gap every 10 bytes
+      for ( uint64_t i = 0; i < 100; ++i ) {
+        test.execute( Insert { string( 9, 'x' ), 10 * i + 1 } );
+      }
+
+      // each gap is filled, from the top down, by a payload that overlaps everything held above it
+      for ( uint64_t gap = 990; gap > 0; gap -= 10 ) {
+        test.execute( Insert { string( 1000 - gap, 'x' ), gap } );
+      }
+      test.execute( BytesPending( 999 ) );
+      test.execute( BytesRetained( 999 ) );
+      expect_budget( *budget, 999, 0 );
+
+      test.execute( Insert { "x", 0 } );
+      test.execute( BytesPushed( 1000 ) );
+      test.execute( BytesRetained( 0 ) );
+    }
+
+    {
+      auto budget = make_shared<ReassemblyBudget>( 6 );
+      ByteStream stream1 { 100 };
+      ByteStream stream2 { 100 };
+      Reassembler first { budget };
+
+      first.insert( 1, "xxxx", false, stream1.writer() );
+      {
+        Reassembler second { budget };
+        second.insert( 1, "yyyy", false, stream2.writer() );
+        expect_budget( *budget, 6, 2 );
+        if ( second.bytes_pending() != 2 or second.bytes_pruned() != 2 ) {
+          throw runtime_error( "second Reassembler should hold 2 bytes and have pruned 2" );
+        }
+
+        // filling the first connection's hole frees budget for the second
+        first.insert( 0, "a", false, stream1.writer() );
+        expect_budget( *budget, 2, 2 );
+        second.insert( 3, "yy", false, stream2.writer() );
+        expect_budget( *budget, 4, 2 );
+        if ( second.bytes_pending() != 4 ) {
+          throw runtime_error( "second Reassembler should hold 4 bytes after budget was freed" );
+        }
+      }
+
+      // a destroyed Reassembler refunds what it held
+      expect_budget( *budget, 0, 2 );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
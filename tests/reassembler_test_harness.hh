@@ -4,6 +4,7 @@
 #include "common.hh"
 #include "reassembler.hh"
 
+#include <memory>
 #include <optional>
 #include <sstream>
 #include <utility>
@@ -28,10 +29,13 @@ struct ReassemblerByteStreamTestStep : public TestStep<StreamAndReassembler>
 class ReassemblerTestHarness : public TestHarness<StreamAndReassembler>
 {
 public:
-  ReassemblerTestHarness( std::string test_name, uint64_t capacity )
+  ReassemblerTestHarness( std::string test_name,
+                          uint64_t capacity,
+                          std::shared_ptr<ReassemblyBudget> budget = {} )
     : TestHarness( move( test_name ),
-                   "capacity=" + std::to_string( capacity ),
-                   { ByteStream { capacity }, Reassembler {} } )
+                   "capacity=" + std::to_string( capacity )
+                     + ( budget ? ", budget=" + std::to_string( budget->capacity() ) : "" ),
+                   { ByteStream { capacity }, Reassembler { budget } } )
   {}
 
   template<std::derived_from<TestStep<ByteStream>> T>
@@ -50,6 +54,20 @@ struct BytesPending : public ExpectNumber<StreamAndReassembler, uint64_t>
   uint64_t value( StreamAndReassembler& sr ) const override { return sr.second.bytes_pending(); }
 };
 
+struct BytesPruned : public ExpectNumber<StreamAndReassembler, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "bytes_pruned"; }
+  uint64_t value( StreamAndReassembler& sr ) const override { return sr.second.bytes_pruned(); }
+};
+
+struct BytesRetained : public ExpectNumber<StreamAndReassembler, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "bytes_retained"; }
+  uint64_t value( StreamAndReassembler& sr ) const override { return sr.second.bytes_retained(); }
+};
+
 struct Insert : public Action<StreamAndReassembler>
 {
   std::string data_;
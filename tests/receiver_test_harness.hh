@@ -8,6 +8,7 @@
 #include <optional>
 #include <sstream>
 #include <utility>
+#include <vector>
 
 using ReceiverSet = std::pair<StreamAndReassembler, TCPReceiver>;
 
@@ -94,6 +95,42 @@ struct ExpectAcknoBetween : public Expectation<ReceiverSet>
   }
 };
 
+struct ExpectSACK : public Expectation<ReceiverSet>
+{
+  std::vector<std::pair<uint32_t, uint32_t>> blocks_;
+
+  explicit ExpectSACK( std::vector<std::pair<uint32_t, uint32_t>> blocks ) : blocks_( std::move( blocks ) ) {}
+
+  std::string description() const override
+  {
+    std::ostringstream ss;
+    ss << "SACK blocks are [";
+    for ( const auto& [left, right] : blocks_ ) {
+      ss << " " << Wrap32 { left } << "-" << Wrap32 { right };
+    }
+    ss << " ]";
+    return ss.str();
+  }
+
+  void execute( ReceiverSet& rs ) const override
+  {
+    const auto blocks = rs.second.sack_blocks( rs.first.second );
+    bool match = blocks.size() == blocks_.size();
+    for ( size_t i = 0; match and i < blocks.size(); ++i ) {
+      match = blocks[i].left == Wrap32 { blocks_[i].first } and blocks[i].right == Wrap32 { blocks_[i].second };
+    }
+    if ( not match ) {
+      std::ostringstream ss;
+      ss << "TCPReceiver reported SACK blocks [";
+      for ( const auto& block : blocks ) {
+        ss << " " << block.left << "-" << block.right;
+      }
+      ss << " ]";
+      throw ExpectationViolation( ss.str() );
+    }
+  }
+};
+
 struct HasAckno : public ExpectBool<ReceiverSet>
 {
   using ExpectBool::ExpectBool;
@@ -0,0 +1,129 @@
+#include "segment_round_trip.hh"
+#include "tcp_segment.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+int main()
+{
+  try {
+    {
+      TCPSegment seg;
+      seg.sender_message.SYN = true;
+      seg.sender_message.seqno = Wrap32 { 1000 };
+      seg.receiver_message.window_scale = 5;
+      seg.receiver_message.sack_permitted = true;
+      seg.receiver_message.window_size = 4321;
+      seg.sender_message.payload = string( "hello" );
+
+      const TCPSegment parsed = round_trip( seg );
+      if ( parsed.receiver_message.window_scale != 5 or not parsed.receiver_message.sack_permitted
+           or parsed.receiver_message.window_size != 4321
+           or string_view( parsed.sender_message.payload ) != "hello" ) {
+        throw runtime_error( "window scale option did not survive a round trip" );
+      }
+
+      seg.sender_message.SYN = false;
+      if ( round_trip( seg ).receiver_message.window_scale.has_value() ) {
+        throw runtime_error( "window scale option sent without SYN" );
+      }
+    }
+
+    {
+      TCPSegment seg;
+      seg.sender_message.SYN = true;
+      seg.sender_message.seqno = Wrap32 { 1000 };
+      seg.receiver_message.sack_permitted = true;
+      seg.sender_message.payload = string( "hello" );
+
+      const TCPSegment parsed = round_trip( seg );
+      if ( not parsed.receiver_message.sack_permitted or not parsed.sender_message.SYN
+           or string_view( parsed.sender_message.payload ) != "hello" ) {
+        throw runtime_error( "SACK-permitted option did not survive a round trip" );
+      }
+
+      seg.sender_message.SYN = false;
+      if ( round_trip( seg ).receiver_message.sack_permitted ) {
+        throw runtime_error( "SACK-permitted option sent without SYN" );
+      }
+    }
+
+    {
+      TCPSegment seg;
+      seg.receiver_message.ackno = Wrap32 { 77 };
+      seg.receiver_message.window_size = 1234;
+      seg.sender_message.payload = string( "payload" );
+      for ( uint32_t i = 0; i < 5; ++i ) {
+        seg.receiver_message.sack.push_back( { Wrap32 { 100 * i + 100 }, Wrap32 { 100 * i + 150 } } );
+      }
+
+      const TCPSegment parsed = round_trip( seg );
+      const auto& sack = parsed.receiver_message.sack;
+      if ( sack.size() != TCPReceiverMessage::MAX_SACK_BLOCKS ) {
+        throw runtime_error( "expected four SACK blocks after a round trip, got " + to_string( sack.size() ) );
+      }
+      for ( uint32_t i = 0; i < sack.size(); ++i ) {
+        if ( sack[i].left != Wrap32 { 100 * i + 100 } or sack[i].right != Wrap32 { 100 * i + 150 } ) {
+          throw runtime_error( "SACK block did not survive a round trip" );
+        }
+      }
+      if ( parsed.receiver_message.ackno != Wrap32 { 77 } or parsed.receiver_message.window_size != 1234
+           or string_view( parsed.sender_message.payload ) != "payload" ) {
+        throw runtime_error( "header fields around the SACK option did not survive a round trip" );
+      }
+    }
+
+    {
+      TCPSegment seg;
+      seg.sender_message.SYN = true;
+      seg.receiver_message.ackno = Wrap32 { 77 };
+      seg.receiver_message.window_scale = 7;
+      seg.receiver_message.sack_permitted = true;
+      for ( uint32_t i = 0; i < 4; ++i ) {
+        seg.receiver_message.sack.push_back( { Wrap32 { 100 * i + 100 }, Wrap32 { 100 * i + 150 } } );
+      }
+
+      // 8 bytes of SYN options leave room for three blocks in the 40 bytes of option space
+      const TCPSegment parsed = round_trip( seg );
+      if ( parsed.receiver_message.sack.size() != 3 or parsed.receiver_message.window_scale != 7
+           or not parsed.receiver_message.sack_permitted ) {
+        throw runtime_error( "expected three SACK blocks next to the SYN options, got "
+                             + to_string( parsed.receiver_message.sack.size() ) );
+      }
+    }
+
+    {
+      TCPSegment seg;
+      seg.sender_message.SYN = true;
+      seg.sender_message.seqno = Wrap32 { 1000 };
+      seg.receiver_message.mss = 8960;
+      seg.receiver_message.window_scale = 7;
+      seg.receiver_message.sack_permitted = true;
+      seg.sender_message.payload = string( "hello" );
+
+      const TCPSegment parsed = round_trip( seg );
+      if ( parsed.receiver_message.mss != 8960 or parsed.receiver_message.window_scale != 7
+           or not parsed.receiver_message.sack_permitted
+           or string_view( parsed.sender_message.payload ) != "hello" ) {
+        throw runtime_error( "MSS option did not survive a round trip" );
+      }
+
+      seg.sender_message.SYN = false;
+      if ( round_trip( seg ).receiver_message.mss.has_value() ) {
+        throw runtime_error( "MSS option sent without SYN" );
+      }
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
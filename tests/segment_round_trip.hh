@@ -0,0 +1,17 @@
+#pragma once
+
+#include "parser.hh"
+#include "tcp_segment.hh"
+
+#include <stdexcept>
+
+// Serialize a segment and parse it back, as it would cross the wire
+inline TCPSegment round_trip( TCPSegment seg )
+{
+  seg.compute_checksum( 0 );
+  TCPSegment parsed;
+  if ( not parse( parsed, serialize( seg ), 0 ) ) {
+    throw std::runtime_error( "TCPSegment failed to parse after serialization" );
+  }
+  return parsed;
+}
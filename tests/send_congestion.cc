@@ -0,0 +1,167 @@
+#include "congestion_control.hh"
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+static constexpr uint64_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.congestion_control = CongestionControl::Algorithm::NewReno;
+
+      TCPSenderTestHarness test { "NewReno: initial window, then slow start", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( ExpectCwnd { 4 * MSS } );
+      test.execute( ExpectSsthresh { UINT64_MAX } );
+      test.execute( Push { string( 20 * MSS, 'x' ) } );
+      for ( int i = 0; i < 4; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( MSS ) );
+      }
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { 4 * MSS } );
+
+      // one segment acknowledged: the window grows by one segment, so two more go out
+      test.execute( AckReceived { Wrap32 { isn + 1 + MSS } }.with_win( 60000 ) );
+      test.execute( ExpectCwnd { 5 * MSS } );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ) );
+      test.execute( ExpectNoSegment {} );
+
+      // a cumulative ACK of several segments still grows it by only one segment
+      test.execute( AckReceived { Wrap32 { isn + 1 + 4 * MSS } }.with_win( 60000 ) );
+      test.execute( ExpectCwnd { 6 * MSS } );
+      test.execute( ExpectSeqnosInFlight { 6 * MSS } );
+      for ( int i = 0; i < 4; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( MSS ) );
+      }
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.congestion_control = CongestionControl::Algorithm::NewReno;
+
+      TCPSenderTestHarness test { "NewReno: the peer's window still applies", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 1500 ) );
+      test.execute( Push { string( 20 * MSS, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ) );
+      test.execute( ExpectMessage {}.with_payload_size( 500 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.congestion_control = CongestionControl::Algorithm::NewReno;
+
+      TCPSenderTestHarness test { "NewReno: timeout collapses the window to one segment", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( Push { string( 20 * MSS, 'x' ) } );
+      for ( int i = 0; i < 4; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( MSS ) );
+      }
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectCwnd { MSS } );
+      test.execute( ExpectSsthresh { 2 * MSS } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1 ).with_payload_size( MSS ) );
+      test.execute( ExpectNoSegment {} );
+
+      // slow start up to ssthresh, then one segment per window's worth of ACKs
+      test.execute( AckReceived { Wrap32 { isn + 1 + 4 * MSS } }.with_win( 60000 ) );
+      test.execute( ExpectCwnd { 2 * MSS } );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { Wrap32 { isn + 1 + 5 * MSS } }.with_win( 60000 ) );
+      test.execute( ExpectCwnd { 2 * MSS } );
+      test.execute( AckReceived { Wrap32 { isn + 1 + 6 * MSS } }.with_win( 60000 ) );
+      test.execute( ExpectCwnd { 3 * MSS } );
+    }
+
+    {
+      // NewReno on its own: a loss halves the flight
+      NewReno reno { MSS };
+      reno.on_loss( 20 * MSS, 0 );
+      if ( reno.cwnd() != 10 * MSS or reno.ssthresh() != 10 * MSS ) {
+        throw runtime_error( "NewReno should halve the flight size on loss" );
+      }
+    }
+
+    {
+      // CUBIC: multiplicative decrease by 0.7, then back to W_max after K seconds
+      Cubic cubic { MSS };
+      for ( int i = 0; i < 96; ++i ) {
+        cubic.on_ack( MSS, 0 );
+      }
+      if ( cubic.cwnd() != 100 * MSS ) {
+        throw runtime_error( "CUBIC slow start did not reach 100 segments" );
+      }
+      cubic.on_rtt_sample( 100 );
+      cubic.on_loss( 100 * MSS, 1000 );
+      if ( cubic.cwnd() != 70 * MSS or cubic.ssthresh() != 70 * MSS ) {
+        throw runtime_error( "CUBIC should reduce the window to 0.7 of its size on loss" );
+      }
+
+      // K = cbrt( W_max * (1 - beta) / C ) seconds
+      const double k_ms = cbrt( 100 * 0.3 / 0.4 ) * 1000;
+      uint64_t now = 1000;
+      uint64_t cwnd_at_k = 0;
+      while ( now < 1000 + 2 * k_ms ) {
+        // one window's worth of ACKs per 100 ms round trip
+        const uint64_t acks = cubic.cwnd() / MSS;
+        for ( uint64_t i = 0; i < acks; ++i ) {
+          cubic.on_ack( MSS, now );
+        }
+        now += 100;
+        if ( cwnd_at_k == 0 and static_cast<double>( now ) >= 1000 + k_ms ) {
+          cwnd_at_k = cubic.cwnd();
+        }
+      }
+      if ( cwnd_at_k < 95 * MSS or cwnd_at_k > 105 * MSS ) {
+        throw runtime_error( "CUBIC should be back near W_max after K seconds, got "
+                             + to_string( cwnd_at_k / MSS ) + " segments" );
+      }
+      // as far above W_max after 2K seconds as it was below it right after the loss
+      if ( cubic.cwnd() < 125 * MSS ) {
+        throw runtime_error( "CUBIC should probe beyond W_max after 2K seconds, got "
+                             + to_string( cubic.cwnd() / MSS ) + " segments" );
+      }
+
+      cubic.on_timeout( cubic.cwnd(), now );
+      if ( cubic.cwnd() != MSS ) {
+        throw runtime_error( "CUBIC should collapse to one segment on timeout" );
+      }
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
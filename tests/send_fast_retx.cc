@@ -0,0 +1,216 @@
+#include "congestion_control.hh"
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+static constexpr uint64_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.fast_retransmit = true;
+
+      TCPSenderTestHarness test { "Three duplicate ACKs resend the missing segment", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 4 * MSS ) );
+      test.execute( Push { string( 4 * MSS, 'x' ) } );
+      for ( uint64_t i = 0; i < 4; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( isn + 1 + i * MSS ) );
+      }
+      test.execute( ExpectNoSegment {} );
+
+      // the first segment was lost; the other three each bring a duplicate ACK
+      test.execute( DuplicateAcks { Wrap32 { isn + 1 }, 2 }.with_win( 4 * MSS ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectFastRecovery { false } );
+      test.execute( DuplicateAcks { Wrap32 { isn + 1 }, 1 }.with_win( 4 * MSS ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( isn + 1 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectFastRecovery { true } );
+      test.execute( ExpectSeqnosInFlight { 4 * MSS } );
+
+      // more duplicates don't resend it again
+      test.execute( DuplicateAcks { Wrap32 { isn + 1 }, 3 }.with_win( 4 * MSS ) );
+      test.execute( ExpectNoSegment {} );
+
+      test.execute( AckReceived { Wrap32 { isn + 1 + 4 * MSS } }.with_win( 4 * MSS ) );
+      test.execute( ExpectFastRecovery { false } );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "Without fast_retransmit, duplicate ACKs wait for the timer", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 4 * MSS ) );
+      test.execute( Push { string( 4 * MSS, 'x' ) } );
+      for ( uint64_t i = 0; i < 4; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( MSS ) );
+      }
+      test.execute( DuplicateAcks { Wrap32 { isn + 1 }, 3 }.with_win( 4 * MSS ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectFastRecovery { false } );
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( isn + 1 ) );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.fast_retransmit = true;
+
+      TCPSenderTestHarness test { "A resend acknowledged before it goes out is dropped", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 4 * MSS ) );
+      test.execute( Push { string( 4 * MSS, 'x' ) } );
+      for ( uint64_t i = 0; i < 4; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( MSS ) );
+      }
+      test.execute( DuplicateAcks { Wrap32 { isn + 1 }, 3 }.with_win( 4 * MSS ).without_push() );
+      test.execute( ExpectFastRecovery { true } );
+      test.execute( AckReceived { Wrap32 { isn + 1 + 4 * MSS } }.with_win( 4 * MSS ).without_push() );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.fast_retransmit = true;
+
+      TCPSenderTestHarness test { "Window updates are not duplicate ACKs", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 2 * MSS ) );
+      test.execute( Push { string( 2 * MSS, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 2 * MSS + 1 ).without_push() );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 2 * MSS + 2 ).without_push() );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 2 * MSS + 3 ).without_push() );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectFastRecovery { false } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.fast_retransmit = true;
+
+      TCPSenderTestHarness test { "Partial ACKs resend the next hole", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 5 * MSS ) );
+      test.execute( Push { string( 5 * MSS, 'x' ) } );
+      for ( uint64_t i = 0; i < 5; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( MSS ) );
+      }
+
+      // the first and third segments were lost
+      test.execute( DuplicateAcks { Wrap32 { isn + 1 }, 3 }.with_win( 5 * MSS ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( isn + 1 ) );
+      test.execute( ExpectFastRecovery { true } );
+
+      test.execute( AckReceived { Wrap32 { isn + 1 + 2 * MSS } }.with_win( 5 * MSS ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( isn + 1 + 2 * MSS ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectFastRecovery { true } );
+
+      test.execute( AckReceived { Wrap32 { isn + 1 + 5 * MSS } }.with_win( 5 * MSS ) );
+      test.execute( ExpectFastRecovery { false } );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.fast_retransmit = true;
+
+      TCPSenderTestHarness test { "Duplicate ACKs for data sent before a timeout don't trigger recovery", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 4 * MSS ) );
+      test.execute( Push { string( 4 * MSS, 'x' ) } );
+      for ( uint64_t i = 0; i < 4; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( MSS ) );
+      }
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( isn + 1 ) );
+      test.execute( DuplicateAcks { Wrap32 { isn + 1 }, 3 }.with_win( 4 * MSS ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectFastRecovery { false } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.fast_retransmit = true;
+      cfg.congestion_control = CongestionControl::Algorithm::NewReno;
+
+      TCPSenderTestHarness test { "NewReno: window through fast recovery", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( Push { string( 20 * MSS, 'x' ) } );
+      for ( int i = 0; i < 4; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( MSS ) );
+      }
+      test.execute( AckReceived { Wrap32 { isn + 1 + MSS } }.with_win( 60000 ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { 5 * MSS } );
+
+      // ssthresh is half the flight, and the window is inflated by the three segments that got through
+      test.execute( DuplicateAcks { Wrap32 { isn + 1 + MSS }, 3 }.with_win( 60000 ).without_push() );
+      test.execute( ExpectSsthresh { 5 * MSS / 2 } );
+      test.execute( ExpectCwnd { 5 * MSS / 2 + 3 * MSS } );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( isn + 1 + MSS ) );
+      test.execute( ExpectNoSegment {} );
+
+      test.execute( DuplicateAcks { Wrap32 { isn + 1 + MSS }, 1 }.with_win( 60000 ).without_push() );
+      test.execute( ExpectCwnd { 5 * MSS / 2 + 4 * MSS } );
+
+      // a partial ACK of two segments deflates the window by them, less the one let out
+      test.execute( AckReceived { Wrap32 { isn + 1 + 3 * MSS } }.with_win( 60000 ).without_push() );
+      test.execute( ExpectCwnd { 5 * MSS / 2 + 3 * MSS } );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( isn + 1 + 3 * MSS ) );
+      test.execute( ExpectFastRecovery { true } );
+
+      // everything outstanding at the loss is acknowledged: back to ssthresh
+      test.execute( AckReceived { Wrap32 { isn + 1 + 6 * MSS } }.with_win( 60000 ) );
+      test.execute( ExpectFastRecovery { false } );
+      test.execute( ExpectCwnd { 5 * MSS / 2 } );
+      test.execute( ExpectSeqnosInFlight { 5 * MSS / 2 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,168 @@
+#include "path_mtu_discovery.hh"
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+static constexpr uint64_t BASE = TCPConfig::MAX_PAYLOAD_SIZE;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.mss = 1460;
+
+      TCPSenderTestHarness test { "The peer's MSS caps the segment size", cfg };
+      test.execute( ExpectSegmentSize { 1460 } );
+      test.execute( PeerMSS { 536 } );
+      test.execute( ExpectSegmentSize { 536 } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 4000 ) );
+      test.execute( Push { string( 2000, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 536 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 536 ).with_seqno( isn + 1 + 536 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 536 ).with_seqno( isn + 1 + 2 * 536 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 392 ).with_seqno( isn + 1 + 3 * 536 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.mss = 8960;
+
+      TCPSenderTestHarness test { "Segments are as large as both sides' MSS allow", cfg };
+      test.execute( PeerMSS { 1460 } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( Push { string( 3000, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1460 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1460 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 80 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.mss = 1460;
+      cfg.plpmtud = true;
+
+      TCPSenderTestHarness test { "An acknowledged probe raises the segment size", cfg };
+      test.execute( PeerMSS { 8960 } );
+      test.execute( ExpectSegmentSize { BASE } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+
+      // not enough data to fill a probe yet
+      test.execute( Push { string( 1200, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( BASE ) );
+      test.execute( ExpectMessage {}.with_payload_size( 200 ) );
+
+      test.execute( Push { string( 5000, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1460 ).with_seqno( isn + 1 + 1200 ) );
+      for ( int i = 0; i < 3; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( BASE ) );
+      }
+      test.execute( ExpectMessage {}.with_payload_size( 540 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSegmentSize { BASE } );
+
+      test.execute( AckReceived { Wrap32 { isn + 1 + 6200 } }.with_win( 60000 ) );
+      test.execute( ExpectSegmentSize { 1460 } );
+      test.execute( Push { string( 3000, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1460 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1460 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 80 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.mss = 1460;
+      cfg.plpmtud = true;
+
+      TCPSenderTestHarness test { "A lost probe is resent as smaller segments, and its size given up after "
+                                  + to_string( PathMTUDiscovery::MAX_PROBES ) + " losses",
+                                  cfg };
+      test.execute( PeerMSS { 1460 } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+
+      uint64_t next = 1;
+      for ( unsigned probe = 0; probe < PathMTUDiscovery::MAX_PROBES; ++probe ) {
+        test.execute( Push { string( 1460 + BASE, 'x' ) } );
+        test.execute( ExpectMessage {}.with_payload_size( 1460 ).with_seqno( isn + next ) );
+        test.execute( ExpectMessage {}.with_payload_size( BASE ).with_seqno( isn + next + 1460 ) );
+        test.execute( ExpectNoSegment {} );
+
+        // the probe is dropped on the way
+        test.execute( Tick { cfg.rt_timeout } );
+        test.execute( ExpectMessage {}.with_payload_size( BASE ).with_seqno( isn + next ) );
+        test.execute( ExpectMessage {}.with_payload_size( 460 ).with_seqno( isn + next + BASE ) );
+        test.execute( ExpectNoSegment {} );
+
+        next += 1460 + BASE;
+        test.execute( AckReceived { Wrap32 { isn + next } }.with_win( 60000 ) );
+        test.execute( ExpectSegmentSize { BASE } );
+      }
+
+      // the search goes on halfway between what works and what doesn't
+      test.execute( Push { string( 1460, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1230 ).with_seqno( isn + next ) );
+      test.execute( ExpectMessage {}.with_payload_size( 230 ) );
+      test.execute( AckReceived { Wrap32 { isn + next + 1460 } }.with_win( 60000 ) );
+      test.execute( ExpectSegmentSize { 1230 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.mss = 1460;
+      cfg.plpmtud = true;
+
+      TCPSenderTestHarness test { "A SACKed probe got through", cfg };
+      const uint64_t room = TCPReceiverMessage::SACK_OPTION_LENGTH; // for the SACK blocks any segment may carry
+      test.execute( UseSack {} );
+      test.execute( PeerMSS { 1460 } );
+      test.execute( ExpectSegmentSize { BASE - room } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( Push { string( BASE - room, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( BASE - room ) );
+
+      // the probe's payload fills the size tried; segments leave the room
+      test.execute( Push { string( 1460, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1460 ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ).with_sack(
+        Wrap32 { isn + 1 + ( BASE - room ) }, Wrap32 { isn + 1 + ( BASE - room + 1460 ) } ) );
+      test.execute( ExpectSegmentSize { 1460 - room } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
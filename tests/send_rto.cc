@@ -0,0 +1,120 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.rtt_estimation = true;
+      cfg.rto_min = 10;
+
+      TCPSenderTestHarness test { "RTO follows the measured RTT", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( Tick { 50 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } } );
+
+      // SRTT = 50, RTTVAR = 25: RTO = 50 + 4 * 25
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ) );
+      test.execute( Tick { 149 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( "abc" ) );
+
+      // exponential back-off from there
+      test.execute( Tick { 299 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( "abc" ) );
+
+      // the ACK of a retransmitted segment is no RTT sample (Karn's algorithm), so the back-off stays
+      test.execute( Tick { 20 } );
+      test.execute( AckReceived { Wrap32 { isn + 4 } } );
+      test.execute( Push { "def" } );
+      test.execute( ExpectMessage {}.with_data( "def" ) );
+      test.execute( Tick { 599 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( "def" ) );
+      test.execute( AckReceived { Wrap32 { isn + 7 } } );
+
+      // until a segment sent once is acknowledged: SRTT = 50, RTTVAR = 18
+      test.execute( Push { "ghi" } );
+      test.execute( ExpectMessage {}.with_data( "ghi" ) );
+      test.execute( Tick { 50 } );
+      test.execute( AckReceived { Wrap32 { isn + 10 } } );
+      test.execute( Push { "jkl" } );
+      test.execute( ExpectMessage {}.with_data( "jkl" ) );
+      test.execute( Tick { 121 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( "jkl" ) );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.rtt_estimation = true;
+      cfg.rto_min = 200;
+
+      TCPSenderTestHarness test { "RTO converges on a steady RTT, no lower than the minimum", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( Tick { 20 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } } );
+      for ( uint32_t i = 0; i < 20; ++i ) {
+        test.execute( Push { "x" } );
+        test.execute( ExpectMessage {}.with_data( "x" ) );
+        test.execute( Tick { 20 } );
+        test.execute( AckReceived { Wrap32 { isn + 2 + i } } );
+      }
+      test.execute( Push { "y" } );
+      test.execute( ExpectMessage {}.with_data( "y" ) );
+      test.execute( Tick { 199 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( "y" ) );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.rtt_estimation = true;
+      cfg.rt_timeout = 1000;
+      cfg.rto_max = 3000;
+
+      TCPSenderTestHarness test { "Back-off stops at the maximum RTO", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      for ( const uint64_t rto : { 1000, 2000, 3000, 3000 } ) {
+        test.execute( Tick { rto - 1 } );
+        test.execute( ExpectNoSegment {} );
+        test.execute( Tick { 1 } );
+        test.execute( ExpectMessage {}.with_syn( true ) );
+      }
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
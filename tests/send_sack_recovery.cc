@@ -0,0 +1,251 @@
+#include "congestion_control.hh"
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+// payload per segment: the MSS less room for the SACK blocks a segment may carry
+static constexpr uint64_t MSS = TCPConfig::MAX_PAYLOAD_SIZE - TCPReceiverMessage::SACK_OPTION_LENGTH;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      auto seg = [&]( uint64_t i ) { return isn + 1 + i * MSS; };
+
+      TCPSenderTestHarness test { "After a timeout, the other holes go out on the next ACK", cfg };
+      test.execute( UseSack {} );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 6 * MSS ) );
+      test.execute( Push { string( 6 * MSS, 'x' ) } );
+      for ( uint64_t i = 0; i < 6; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( seg( i ) ) );
+      }
+
+      // segments 0, 2 and 4 are lost
+      test.execute( AckReceived { seg( 0 ) }
+                      .with_win( 6 * MSS )
+                      .with_sack( seg( 5 ), seg( 6 ) )
+                      .with_sack( seg( 1 ), seg( 2 ) )
+                      .with_sack( seg( 3 ), seg( 4 ) ) );
+      test.execute( ExpectNoSegment {} );
+
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( seg( 0 ) ) );
+      test.execute( ExpectNoSegment {} );
+
+      // the resent segment 0 arrives: the two holes left are resent together, the segments SACKed again never
+      test.execute( AckReceived { seg( 2 ) }
+                      .with_win( 6 * MSS )
+                      .with_sack( seg( 5 ), seg( 6 ) )
+                      .with_sack( seg( 3 ), seg( 4 ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( seg( 2 ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( seg( 4 ) ) );
+      test.execute( ExpectNoSegment {} );
+
+      test.execute( AckReceived { seg( 6 ) }.with_win( 6 * MSS ) );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      auto seg = [&]( uint64_t i ) { return isn + 1 + i * MSS; };
+
+      TCPSenderTestHarness test { "A timeout forgets the SACKs: data the peer dropped since goes again", cfg };
+      test.execute( UseSack {} );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 2 * MSS ) );
+      test.execute( Push { string( 2 * MSS, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( seg( 0 ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( seg( 1 ) ) );
+      test.execute( AckReceived { seg( 0 ) }.with_win( 2 * MSS ).with_sack( seg( 1 ), seg( 2 ) ) );
+      test.execute( ExpectNoSegment {} );
+
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( seg( 0 ) ) );
+      test.execute( ExpectNoSegment {} );
+
+      // the peer ran short of memory and dropped segment 1, which it no longer SACKs
+      test.execute( AckReceived { seg( 1 ) }.with_win( 2 * MSS ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( seg( 1 ) ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { seg( 2 ) }.with_win( 2 * MSS ) );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.mss = MSS; // the same segments as with SACK
+      auto seg = [&]( uint64_t i ) { return isn + 1 + i * MSS; };
+
+      TCPSenderTestHarness test { "Without SACK, the holes after a timeout wait for a timeout each", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 6 * MSS ) );
+      test.execute( Push { string( 6 * MSS, 'x' ) } );
+      for ( uint64_t i = 0; i < 6; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( MSS ) );
+      }
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( seg( 0 ) ) );
+      test.execute( AckReceived { seg( 2 ) }.with_win( 6 * MSS ).with_sack( seg( 3 ), seg( 4 ) ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.fast_retransmit = true;
+      auto seg = [&]( uint64_t i ) { return isn + 1 + i * MSS; };
+
+      TCPSenderTestHarness test { "Fast retransmit resends every hole SACK shows, within a round trip", cfg };
+      test.execute( UseSack {} );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 6 * MSS ) );
+      test.execute( Push { string( 6 * MSS, 'x' ) } );
+      for ( uint64_t i = 0; i < 6; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( MSS ) );
+      }
+
+      // segments 0 and 2 are lost; each of the others brings an ACK SACKing it
+      test.execute( AckReceived { seg( 0 ) }.with_win( 6 * MSS ).with_sack( seg( 1 ), seg( 2 ) ) );
+      test.execute( AckReceived { seg( 0 ) }
+                      .with_win( 6 * MSS )
+                      .with_sack( seg( 3 ), seg( 4 ) )
+                      .with_sack( seg( 1 ), seg( 2 ) ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { seg( 0 ) }
+                      .with_win( 6 * MSS )
+                      .with_sack( seg( 3 ), seg( 5 ) )
+                      .with_sack( seg( 1 ), seg( 2 ) ) );
+      test.execute( ExpectFastRecovery { true } );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( seg( 0 ) ) );
+      test.execute( ExpectNoSegment {} );
+
+      // with three segments SACKed above it, segment 2 is lost too, and goes out before any ACK of the first
+      test.execute( AckReceived { seg( 0 ) }
+                      .with_win( 6 * MSS )
+                      .with_sack( seg( 3 ), seg( 6 ) )
+                      .with_sack( seg( 1 ), seg( 2 ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( seg( 2 ) ) );
+      test.execute( ExpectNoSegment {} );
+
+      // the partial ACK for the first repair resends nothing more
+      test.execute( AckReceived { seg( 2 ) }.with_win( 6 * MSS ).with_sack( seg( 3 ), seg( 6 ) ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectFastRecovery { true } );
+
+      test.execute( AckReceived { seg( 6 ) }.with_win( 6 * MSS ) );
+      test.execute( ExpectFastRecovery { false } );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.fast_retransmit = true;
+      auto seg = [&]( uint64_t i ) { return isn + 1 + i * MSS; };
+
+      TCPSenderTestHarness test { "A hole SACKed before its resend goes out is not resent", cfg };
+      test.execute( UseSack {} );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 6 * MSS ) );
+      test.execute( Push { string( 6 * MSS, 'x' ) } );
+      for ( uint64_t i = 0; i < 6; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( MSS ) );
+      }
+      test.execute( AckReceived { seg( 0 ) }.with_win( 6 * MSS ).with_sack( seg( 3 ), seg( 6 ) ) );
+      test.execute( ExpectFastRecovery { true } );
+
+      // segments 0, 1 and 2 are resent, but 1 and 2 were only late and arrive before they go out
+      test.execute( AckReceived { seg( 0 ) }.with_win( 6 * MSS ).with_sack( seg( 1 ), seg( 6 ) ).without_push() );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( seg( 0 ) ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.fast_retransmit = true;
+      cfg.congestion_control = CongestionControl::Algorithm::NewReno;
+      auto seg = [&]( uint64_t i ) { return isn + 1 + i * MSS; };
+
+      TCPSenderTestHarness test { "NewReno with SACK: the pipe limits what goes out in recovery", cfg };
+      test.execute( UseSack {} );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( Push { string( 20 * MSS, 'x' ) } );
+      for ( int i = 0; i < 4; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( MSS ) );
+      }
+      test.execute( AckReceived { seg( 1 ) }.with_win( 60000 ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectPipe { 5 * MSS } );
+
+      // segments 1 and 3 are lost; 2, 4 and 5 are SACKed
+      test.execute( AckReceived { seg( 1 ) }.with_win( 60000 ).with_sack( seg( 2 ), seg( 3 ) ).without_push() );
+      test.execute( AckReceived { seg( 1 ) }
+                      .with_win( 60000 )
+                      .with_sack( seg( 4 ), seg( 5 ) )
+                      .with_sack( seg( 2 ), seg( 3 ) )
+                      .without_push() );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectPipe { 3 * MSS } );
+      test.execute( AckReceived { seg( 1 ) }
+                      .with_win( 60000 )
+                      .with_sack( seg( 4 ), seg( 6 ) )
+                      .with_sack( seg( 2 ), seg( 3 ) ) );
+
+      // ssthresh and cwnd are half the flight, not inflated; segment 3 still counts as in the network
+      test.execute( ExpectFastRecovery { true } );
+      test.execute( ExpectSsthresh { 5 * MSS / 2 } );
+      test.execute( ExpectCwnd { 5 * MSS / 2 } );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( seg( 1 ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS / 2 ).with_seqno( seg( 6 ) ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectPipe { 5 * MSS / 2 } );
+
+      // the repair arrives: segment 3 is now the earliest hole and is resent as the pipe drains
+      test.execute( AckReceived { seg( 3 ) }.with_win( 60000 ).with_sack( seg( 4 ), seg( 6 ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( seg( 3 ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( seg( 6 ) + MSS / 2 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectFastRecovery { true } );
+
+      test.execute( AckReceived { seg( 6 ) + MSS / 2 }.with_win( 60000 ) );
+      test.execute( ExpectFastRecovery { false } );
+      test.execute( ExpectCwnd { 5 * MSS / 2 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,145 @@
+#include "allocation_counter.hh"
+#include "byte_stream.hh"
+#include "tcp_config.hh"
+#include "tcp_sender.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+/*
+ * Benchmark for the TCPSender's send path: a stream is pushed, sent and acknowledged in order while the
+ * window stays full, so every segment is appended to the retransmission queue, sent once and retired by
+ * a cumulative ACK. Prints one JSON array with ns per segment and heap allocations per segment for each
+ * window size and ACK frequency.
+ */
+
+namespace {
+
+struct Pattern
+{
+  string name;
+  uint64_t window;    // the receiver's window, in bytes
+  uint64_t ack_every; // segments acknowledged by each ACK
+};
+
+constexpr uint8_t window_scale = 5;
+constexpr uint64_t stream_length = 1 << 26;
+
+TCPReceiverMessage ack( Wrap32 isn, uint64_t absolute_ackno, uint64_t window )
+{
+  TCPReceiverMessage msg;
+  msg.ackno = Wrap32::wrap( absolute_ackno, isn );
+  msg.window_size = static_cast<uint16_t>( window >> window_scale );
+  return msg;
+}
+
+string run( const Pattern& pattern )
+{
+  TCPConfig cfg;
+  cfg.fixed_isn = Wrap32 { 1370 };
+  const Wrap32 isn = cfg.fixed_isn.value();
+
+  // the whole stream is written up front, so only the sender is timed
+  ByteStream stream { stream_length };
+  stream.writer().push( string( stream_length, 'x' ) );
+  stream.writer().close();
+
+  TCPSender sender { cfg };
+  sender.set_window_scale( window_scale );
+
+  // the handshake
+  sender.push( stream.reader() );
+  if ( not sender.maybe_send().has_value() ) {
+    throw runtime_error( pattern.name + ": no SYN" );
+  }
+  sender.receive( ack( isn, 1, pattern.window ) );
+
+  deque<uint64_t> segment_ends; // absolute seqno after each segment in flight, oldest first
+  uint64_t segments = 0;
+  bool fin_sent = false;
+
+  const uint64_t allocs_before = allocations.load();
+  const auto start_time = steady_clock::now();
+
+  while ( not fin_sent ) {
+    // fill the window, then acknowledge the oldest segments as if a round trip had passed
+    sender.push( stream.reader() );
+    while ( auto msg = sender.maybe_send() ) {
+      const uint64_t seqno = msg->seqno.unwrap( isn, segment_ends.empty() ? 1 : segment_ends.back() );
+      segment_ends.push_back( seqno + msg->sequence_length() );
+      segments++;
+      fin_sent = msg->FIN; // acknowledged below with the rest of the flight
+    }
+
+    if ( segment_ends.empty() ) {
+      throw runtime_error( pattern.name + ": sender stalled" );
+    }
+
+    const uint64_t count = fin_sent ? segment_ends.size() : min<uint64_t>( pattern.ack_every, segment_ends.size() );
+    uint64_t ackno = 0;
+    for ( uint64_t i = 0; i < count; ++i ) {
+      ackno = segment_ends.front();
+      segment_ends.pop_front();
+    }
+    sender.receive( ack( isn, ackno, pattern.window ) );
+  }
+
+  const auto stop_time = steady_clock::now();
+  const uint64_t allocs = allocations.load() - allocs_before;
+
+  if ( sender.sequence_numbers_in_flight() != 0 ) {
+    throw runtime_error( pattern.name + ": data left in flight" );
+  }
+
+  const double seconds = duration_cast<duration<double>>( stop_time - start_time ).count();
+
+  ostringstream out;
+  out << fixed << setprecision( 3 );
+  out << R"({"pattern": ")" << pattern.name << R"(", "window": )" << pattern.window << R"(, "ack_every": )"
+      << pattern.ack_every << R"(, "segments": )" << segments << R"(, "ns_per_segment": )"
+      << seconds * 1e9 / static_cast<double>( segments ) << R"(, "allocations_per_segment": )"
+      << static_cast<double>( allocs ) / static_cast<double>( segments ) << "}";
+  return out.str();
+}
+
+void program_body()
+{
+  const vector<Pattern> all {
+    { "small_window", 64000, 2 },
+    { "large_window", 1 << 20, 2 },
+    { "stretch_acks", 1 << 20, 64 },
+  };
+
+  cout << "[\n";
+  for ( size_t i = 0; i < all.size(); ++i ) {
+    cout << "  " << run( all[i] ) << ( i + 1 < all.size() ? ",\n" : "\n" );
+  }
+  cout << "]\n";
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -54,6 +54,41 @@ struct ExpectSeqnosInFlight : public ExpectNumber<StreamAndSender, uint64_t>
   uint64_t value( StreamAndSender& ss ) const override { return ss.second.sequence_numbers_in_flight(); }
 };
 
+struct ExpectCwnd : public ExpectNumber<StreamAndSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "congestion_control()->cwnd()"; }
+  uint64_t value( StreamAndSender& ss ) const override { return ss.second.congestion_control()->cwnd(); }
+};
+
+struct ExpectSsthresh : public ExpectNumber<StreamAndSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "congestion_control()->ssthresh()"; }
+  uint64_t value( StreamAndSender& ss ) const override { return ss.second.congestion_control()->ssthresh(); }
+};
+
+struct ExpectPipe : public ExpectNumber<StreamAndSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "pipe"; }
+  uint64_t value( StreamAndSender& ss ) const override { return ss.second.pipe(); }
+};
+
+struct ExpectSegmentSize : public ExpectNumber<StreamAndSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "segment_size"; }
+  uint64_t value( StreamAndSender& ss ) const override { return ss.second.segment_size(); }
+};
+
+struct ExpectFastRecovery : public ExpectBool<StreamAndSender>
+{
+  using ExpectBool::ExpectBool;
+  std::string name() const override { return "in_fast_recovery"; }
+  bool value( StreamAndSender& ss ) const override { return ss.second.in_fast_recovery(); }
+};
+
 struct ExpectNoSegment : public Expectation<StreamAndSender>
 {
   std::string description() const override { return "nothing to send"; }
@@ -154,7 +189,11 @@ struct Receive : public Action<StreamAndSender>
   std::string description() const override
   {
     std::ostringstream desc;
-    desc << "receive(ack=" << to_string( msg_.ackno ) << ", win=" << msg_.window_size << ")";
+    desc << "receive(ack=" << to_string( msg_.ackno ) << ", win=" << msg_.window_size;
+    for ( const auto& [left, right] : msg_.sack ) {
+      desc << ", sack=[" << left << ", " << right << ")";
+    }
+    desc << ")";
     if ( push_ ) {
       desc << ", then push stream to TCPSender";
     }
@@ -167,6 +206,12 @@ struct Receive : public Action<StreamAndSender>
     return *this;
   }
 
+  Receive& with_sack( Wrap32 left, Wrap32 right )
+  {
+    msg_.sack.push_back( { left, right } );
+    return *this;
+  }
+
   void execute( StreamAndSender& ss ) const override
   {
     ss.second.receive( msg_ );
@@ -187,6 +232,56 @@ struct AckReceived : public Receive
   explicit AckReceived( Wrap32 ackno ) : Receive( { ackno, DEFAULT_TEST_WINDOW } ) {}
 };
 
+struct DuplicateAcks : public Receive
+{
+  unsigned count_;
+
+  DuplicateAcks( Wrap32 ackno, unsigned count ) : Receive( { ackno, DEFAULT_TEST_WINDOW } ), count_( count ) {}
+  std::string description() const override { return std::to_string( count_ ) + " x " + Receive::description(); }
+
+  void execute( StreamAndSender& ss ) const override
+  {
+    for ( unsigned i = 0; i < count_; ++i ) {
+      ss.second.receive( msg_ );
+    }
+    if ( push_ ) {
+      ss.second.push( ss.first.reader() );
+    }
+  }
+};
+
+struct UseSack : public Action<StreamAndSender>
+{
+  std::string description() const override { return "SACK negotiated"; }
+  void execute( StreamAndSender& ss ) const override { ss.second.use_sack(); }
+};
+
+struct PeerMSS : public Action<StreamAndSender>
+{
+  uint64_t mss_;
+
+  explicit PeerMSS( uint64_t mss ) : mss_( mss ) {}
+  std::string description() const override { return "peer's MSS is " + std::to_string( mss_ ); }
+  void execute( StreamAndSender& ss ) const override { ss.second.set_peer_mss( mss_ ); }
+};
+
+struct Cork : public Action<StreamAndSender>
+{
+  std::string description() const override { return "cork"; }
+  void execute( StreamAndSender& ss ) const override { ss.second.cork(); }
+};
+
+// Uncork, then push to TCPSender
+struct Uncork : public Action<StreamAndSender>
+{
+  std::string description() const override { return "uncork, then push to TCPSender"; }
+  void execute( StreamAndSender& ss ) const override
+  {
+    ss.second.uncork( ss.first.reader() );
+    ss.second.push( ss.first.reader() );
+  }
+};
+
 struct Close : public Push
 {
   Close() : Push( "" ) { with_close(); }
@@ -290,7 +385,7 @@ struct ExpectMessage : public Expectation<StreamAndSender>
     if ( payload_size.has_value() and seg.payload.size() != payload_size.value() ) {
       throw ExpectationViolation( "payload_size", payload_size.value(), seg.payload.size() );
     }
-    if ( seg.payload.size() > TCPConfig::MAX_PAYLOAD_SIZE ) {
+    if ( seg.payload.size() > ss.second.max_segment_size() ) {
       throw ExpectationViolation( "payload has length (" + std::to_string( seg.payload.size() )
                                   + ") greater than the maximum" );
     }
@@ -307,6 +402,6 @@ public:
   TCPSenderTestHarness( std::string name, TCPConfig config )
     : TestHarness( move( name ),
                    "initial_RTO_ms=" + to_string( config.rt_timeout ),
-                   { ByteStream { config.send_capacity }, TCPSender { config.rt_timeout, config.fixed_isn } } )
+                   { ByteStream { config.send_capacity }, TCPSender { config } } )
   {}
 };
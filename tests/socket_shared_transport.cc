@@ -0,0 +1,108 @@
+#include "fd_adapter.hh"
+#include "parser.hh"
+#include "tcp_minnow_socket.cc"
+#include "test_should_be.hh"
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <span>
+#include <string>
+#include <thread>
+
+using namespace std;
+
+//! Carries serialized TCP segments over one end of a Unix-domain datagram socket pair
+class LoopbackAdapter : public FdAdapterBase
+{
+  FileDescriptor _fd;
+
+public:
+  explicit LoopbackAdapter( FileDescriptor&& fd ) : _fd( move( fd ) ) {}
+
+  optional<TCPSegment> read()
+  {
+    string datagram;
+    _fd.read( datagram );
+    TCPSegment seg;
+    if ( not parse( seg, vector<Buffer> { move( datagram ) }, 0 ) ) {
+      return {};
+    }
+    return seg;
+  }
+
+  void write( TCPSegment& seg )
+  {
+    seg.compute_checksum( 0 );
+    _fd.write( serialize( seg ) );
+  }
+
+  FileDescriptor& fd() { return _fd; }
+};
+
+using LoopbackSocket = TCPMinnowSocket<LoopbackAdapter>;
+
+static string pattern( size_t len, char first )
+{
+  string data( len, '\0' );
+  for ( size_t i = 0; i < len; ++i ) {
+    data[i] = static_cast<char>( first + ( i * 7 + i / 251 ) % 26 );
+  }
+  return data;
+}
+
+static string read_all( LoopbackSocket& sock )
+{
+  string received;
+  string buffer( 3000, '\0' );
+  while ( const size_t len = sock.read_shared( span { buffer } ) ) {
+    received.append( buffer.data(), len );
+  }
+  return received;
+}
+
+int main()
+{
+  try {
+    // two TCPMinnowSockets, each with its own TCPPeer thread, exchange data in both directions
+    // through the shared-memory transport; the rings are smaller than the data so they wrap and fill up
+    TCPConfig cfg;
+    cfg.rt_timeout = 20; // keep the final linger short
+    constexpr uint64_t ring_capacity = 4096;
+
+    auto [client_fd, server_fd] = socket_pair_helper( SOCK_DGRAM );
+    LoopbackSocket client { LoopbackAdapter { move( client_fd ) } };
+    LoopbackSocket server { LoopbackAdapter { move( server_fd ) } };
+    client.use_shared_memory_transport( ring_capacity );
+    server.use_shared_memory_transport( ring_capacity );
+
+    const string request = pattern( 300000, 'a' );
+    const string response = pattern( 200000, 'A' );
+
+    string server_received;
+    thread server_thread( [&] {
+      server.listen_and_accept( cfg, {} );
+      server_received = read_all( server );
+      server.write_shared( response );
+      server.shutdown_shared_write();
+      server.wait_until_closed();
+    } );
+
+    client.connect( cfg, {} );
+    client.write_shared( request );
+    client.shutdown_shared_write();
+    const string client_received = read_all( client );
+    client.wait_until_closed();
+    server_thread.join();
+
+    test_should_be( server_received.size(), request.size() );
+    test_should_be( server_received == request, true );
+    test_should_be( client_received.size(), response.size() );
+    test_should_be( client_received == response, true );
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,168 @@
+#include "spsc_channel.hh"
+#include "test_should_be.hh"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+using namespace std;
+using namespace chrono_literals;
+
+// Long enough that a waiter which should stay blocked would have woken up by now
+static constexpr auto SETTLE = 50ms;
+
+static string pattern( size_t len )
+{
+  string data( len, '\0' );
+  for ( size_t i = 0; i < len; ++i ) {
+    data[i] = static_cast<char>( 'a' + ( i * 7 + i / 13 ) % 26 );
+  }
+  return data;
+}
+
+// Stream `total` bytes through a small ring with uneven write and read sizes, so the
+// indices wrap many times and both sides keep blocking on a full or empty ring
+static void stream_through( uint64_t capacity, size_t total )
+{
+  SPSCChannel channel { capacity };
+  const string data = pattern( total );
+
+  thread producer( [&] {
+    size_t written = 0;
+    for ( size_t chunk = 1; written < total; chunk = chunk % 11 + 1 ) {
+      const string_view piece = string_view { data }.substr( written, chunk );
+      size_t done = 0;
+      while ( done < piece.size() ) {
+        done += channel.write( piece.substr( done ) );
+        if ( done < piece.size() ) {
+          channel.wait_writable();
+        }
+      }
+      written += piece.size();
+    }
+    channel.close();
+  } );
+
+  string received;
+  string buffer( 5, '\0' );
+  for ( size_t len = 1;; len = len % buffer.size() + 1 ) {
+    channel.wait_readable();
+    if ( channel.is_finished() ) {
+      break;
+    }
+    received.append( buffer.data(), channel.read( span { buffer.data(), len } ) );
+  }
+  producer.join();
+
+  test_should_be( received.size(), data.size() );
+  test_should_be( received == data, true );
+  test_should_be( channel.bytes_buffered(), uint64_t { 0 } );
+}
+
+int main()
+{
+  try {
+    // capacity must be positive
+    {
+      bool threw = false;
+      try {
+        const SPSCChannel channel { 0 };
+      } catch ( const runtime_error& ) {
+        threw = true;
+      }
+      test_should_be( threw, true );
+    }
+
+    // a write wraps around the end of the ring
+    {
+      SPSCChannel channel { 8 };
+      string out( 8, '\0' );
+      test_should_be( channel.write( "abcdef" ), size_t { 6 } );
+      test_should_be( channel.read( span { out.data(), 4 } ), size_t { 4 } );
+      test_should_be( channel.write( "ghijklmnop" ), size_t { 6 } );
+      test_should_be( channel.available_capacity(), uint64_t { 0 } );
+      test_should_be( channel.read( span { out.data(), out.size() } ), size_t { 8 } );
+      test_should_be( out == "efghijkl", true );
+    }
+
+    // two threads, many wraparounds
+    stream_through( 1, 1000 );
+    stream_through( 7, 100000 );
+    stream_through( 64, 100000 );
+
+    // the producer blocks on a full ring until the consumer makes room
+    {
+      SPSCChannel channel { 4 };
+      channel.write( "abcd" );
+      atomic_bool woke { false };
+      thread producer( [&] {
+        channel.wait_writable();
+        woke = true;
+      } );
+      this_thread::sleep_for( SETTLE );
+      test_should_be( woke.load(), false );
+      string out( 1, '\0' );
+      channel.read( span { out.data(), 1 } );
+      producer.join();
+      test_should_be( woke.load(), true );
+      test_should_be( channel.available_capacity(), uint64_t { 1 } );
+    }
+
+    // the consumer blocks on an empty ring until the producer writes
+    {
+      SPSCChannel channel { 4 };
+      atomic_bool woke { false };
+      thread consumer( [&] {
+        channel.wait_readable();
+        woke = true;
+      } );
+      this_thread::sleep_for( SETTLE );
+      test_should_be( woke.load(), false );
+      channel.write( "x" );
+      consumer.join();
+      test_should_be( woke.load(), true );
+      test_should_be( channel.bytes_buffered(), uint64_t { 1 } );
+    }
+
+    // closing the write side wakes a blocked consumer, which drains what is left
+    {
+      SPSCChannel channel { 4 };
+      string out( 4, '\0' );
+      size_t drained = 0;
+      thread consumer( [&] {
+        channel.wait_readable();
+        drained = channel.read( span { out.data(), out.size() } );
+        channel.wait_readable();
+      } );
+      channel.write( "ab" );
+      this_thread::sleep_for( SETTLE );
+      channel.close();
+      consumer.join();
+      test_should_be( drained, size_t { 2 } );
+      test_should_be( channel.is_finished(), true );
+    }
+
+    // closing the read side wakes a producer blocked on a full ring
+    {
+      SPSCChannel channel { 4 };
+      channel.write( "abcd" );
+      thread producer( [&] { channel.wait_writable(); } );
+      this_thread::sleep_for( SETTLE );
+      channel.close_read();
+      producer.join();
+      test_should_be( channel.reader_closed(), true );
+      test_should_be( channel.available_capacity(), uint64_t { 0 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
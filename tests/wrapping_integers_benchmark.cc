@@ -0,0 +1,110 @@
+#include "wrapping_integers.hh"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+/*
+ * Microbenchmark for Wrap32::unwrap: the previous two-candidate implementation against the
+ * branch-free one, one seqno at a time and in bulk. Prints ns per unwrap as JSON.
+ */
+
+namespace {
+
+class ReferenceWrap32 : public Wrap32
+{
+public:
+  explicit ReferenceWrap32( Wrap32 w ) : Wrap32( w ) {}
+
+  uint32_t raw_value() const { return raw_value_; }
+
+  // The implementation Wrap32::unwrap replaced
+  uint64_t unwrap( uint32_t zero_point, uint64_t checkpoint ) const
+  {
+    uint64_t high_32 = checkpoint & 0xFFFFFFFF00000000;
+    uint64_t roundpoint_1 = static_cast<uint64_t>( raw_value_ - zero_point ) + high_32;
+    uint64_t roundpoint_2 = roundpoint_1 <= checkpoint ? roundpoint_1 + 0x100000000 : roundpoint_1 - 0x100000000;
+    uint64_t diff_1 = roundpoint_1 > checkpoint ? roundpoint_1 - checkpoint : checkpoint - roundpoint_1;
+    uint64_t diff_2 = roundpoint_2 > checkpoint ? roundpoint_2 - checkpoint : checkpoint - roundpoint_2;
+    return diff_1 < diff_2 ? roundpoint_1 : roundpoint_2;
+  }
+};
+
+template<typename F>
+double ns_per_unwrap( size_t count, size_t rounds, F&& body )
+{
+  const auto start_time = steady_clock::now();
+  for ( size_t round = 0; round < rounds; ++round ) {
+    body();
+  }
+  const auto stop_time = steady_clock::now();
+  return duration_cast<duration<double, nano>>( stop_time - start_time ).count()
+         / static_cast<double>( count * rounds );
+}
+
+void program_body()
+{
+  constexpr size_t count = 1 << 16;
+  constexpr size_t rounds = 200;
+
+  default_random_engine rd { 1982 };
+  const Wrap32 isn { static_cast<uint32_t>( rd() ) };
+  const uint64_t checkpoint = ( 5UL << 32 ) + rd();
+
+  // seqnos near the checkpoint, as received segments would be, with some on each side of a wrap
+  vector<Wrap32> seqnos;
+  normal_distribution<double> offset { 0, 1 << 20 };
+  for ( size_t i = 0; i < count; ++i ) {
+    seqnos.push_back( Wrap32::wrap( checkpoint + static_cast<int64_t>( offset( rd ) ), isn ) );
+  }
+
+  vector<uint64_t> reference( count );
+  vector<uint64_t> scalar( count );
+  vector<uint64_t> batch( count );
+  const uint32_t isn_raw = ReferenceWrap32 { isn }.raw_value();
+
+  const double reference_ns = ns_per_unwrap( count, rounds, [&] {
+    for ( size_t i = 0; i < count; ++i ) {
+      reference[i] = ReferenceWrap32 { seqnos[i] }.unwrap( isn_raw, checkpoint );
+    }
+  } );
+
+  const double scalar_ns = ns_per_unwrap( count, rounds, [&] {
+    for ( size_t i = 0; i < count; ++i ) {
+      scalar[i] = seqnos[i].unwrap( isn, checkpoint );
+    }
+  } );
+
+  const double batch_ns = ns_per_unwrap( count, rounds, [&] { Wrap32::unwrap( seqnos, isn, checkpoint, batch ); } );
+
+  if ( reference != scalar or scalar != batch ) {
+    throw runtime_error( "unwrap implementations disagree" );
+  }
+
+  cout << fixed << setprecision( 3 );
+  cout << R"({"unwraps": )" << count * rounds << R"(, "reference_ns": )" << reference_ns << R"(, "scalar_ns": )"
+       << scalar_ns << R"(, "batch_ns": )" << batch_ns << "}\n";
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,74 @@
+#include "random.hh"
+#include "test_should_be.hh"
+#include "wrapping_integers.hh"
+
+#include <array>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// The whole toolkit is usable at compile time
+static_assert( Wrap32::wrap( 5, Wrap32 { UINT32_MAX } ) == Wrap32 { 4 } );
+static_assert( Wrap32 { 4 }.unwrap( Wrap32 { UINT32_MAX }, 0 ) == 5 );
+static_assert( Wrap32 { 1 }.unwrap( Wrap32 { 0 }, UINT32_MAX ) == ( 1UL << 32 ) + 1 );
+static_assert( Wrap32 { UINT32_MAX }.before( Wrap32 { 2 } ) );
+static_assert( Wrap32 { 2 }.after( Wrap32 { UINT32_MAX } ) );
+static_assert( Wrap32 { UINT32_MAX }.distance_to( Wrap32 { 2 } ) == 3 );
+
+int main()
+{
+  try {
+    // Serial number comparison across the wrap
+    test_should_be( Wrap32( 10 ).before( Wrap32( 11 ) ), true );
+    test_should_be( Wrap32( 11 ).before( Wrap32( 10 ) ), false );
+    test_should_be( Wrap32( 10 ).before( Wrap32( 10 ) ), false );
+    test_should_be( Wrap32( 10 ).after( Wrap32( 10 ) ), false );
+    test_should_be( Wrap32( UINT32_MAX - 5 ).before( Wrap32( 5 ) ), true );
+    test_should_be( Wrap32( 5 ).after( Wrap32( UINT32_MAX - 5 ) ), true );
+    test_should_be( Wrap32( 5 ).distance_to( Wrap32( UINT32_MAX - 5 ) ), -11 );
+
+    // RFC 1982 leaves seqnos exactly half the space apart unordered
+    test_should_be( Wrap32( 0 ).before( Wrap32( 1U << 31 ) ), false );
+    test_should_be( Wrap32( 0 ).after( Wrap32( 1U << 31 ) ), false );
+
+    constexpr size_t N_REPS = 32768;
+
+    auto rd = get_random_engine();
+
+    for ( size_t i = 0; i < N_REPS; i++ ) {
+      const uint32_t n = rd();
+      const int32_t step = static_cast<int32_t>( rd() ) / 2;
+      const Wrap32 a { n };
+      const Wrap32 b = a + static_cast<uint32_t>( step );
+      test_should_be( a.distance_to( b ), step );
+      test_should_be( a.before( b ), step > 0 );
+      test_should_be( a.after( b ), step < 0 );
+      test_should_be( b.after( a ), step > 0 );
+    }
+
+    // Batch unwrap agrees with one-at-a-time unwrap
+    for ( size_t i = 0; i < 64; i++ ) {
+      const Wrap32 isn { static_cast<uint32_t>( rd() ) };
+      const uint64_t checkpoint = ( static_cast<uint64_t>( rd() ) << 8 ) + rd();
+      vector<Wrap32> seqnos;
+      for ( size_t j = 0; j < 257; j++ ) {
+        seqnos.emplace_back( static_cast<uint32_t>( rd() ) );
+      }
+      vector<uint64_t> absolute( seqnos.size() );
+      Wrap32::unwrap( seqnos, isn, checkpoint, absolute );
+      for ( size_t j = 0; j < seqnos.size(); j++ ) {
+        test_should_be( absolute[j], seqnos[j].unwrap( isn, checkpoint ) );
+      }
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
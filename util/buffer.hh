@@ -20,4 +20,5 @@ public:
   size_t size() const { return buffer_->size(); }
   size_t length() const { return buffer_->length(); }
   bool empty() const { return buffer_->empty(); }
+  bool unique() const { return buffer_.use_count() == 1; } // Is this the only reference to the string?
 };
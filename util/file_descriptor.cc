@@ -3,8 +3,11 @@
 #include "exception.hh"
 
 #include <algorithm>
+#include <array>
+#include <climits>
 #include <fcntl.h>
 #include <iostream>
+#include <span>
 #include <stdexcept>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -150,6 +153,44 @@ void FileDescriptor::read( vector<string>& buffers )
   }
 }
 
+size_t FileDescriptor::read( span<const span<char>> buffers )
+{
+  if ( buffers.size() > kMaxReadRegions ) {
+    throw runtime_error( "read() given more than " + to_string( kMaxReadRegions ) + " regions" );
+  }
+
+  array<iovec, kMaxReadRegions> iovecs {};
+  size_t total_size = 0;
+  for ( size_t i = 0; i < buffers.size(); ++i ) {
+    iovecs.at( i ) = { buffers[i].data(), buffers[i].size() };
+    total_size += buffers[i].size();
+  }
+
+  if ( total_size == 0 ) {
+    return 0;
+  }
+
+  const ssize_t bytes_read = ::readv( fd_num(), iovecs.data(), static_cast<int>( buffers.size() ) );
+  if ( bytes_read < 0 ) {
+    if ( internal_fd_->non_blocking_ and ( errno == EAGAIN or errno == EINPROGRESS ) ) {
+      return 0;
+    }
+    throw unix_error { "read" };
+  }
+
+  register_read();
+
+  if ( bytes_read == 0 ) {
+    internal_fd_->eof_ = true;
+  }
+
+  if ( bytes_read > static_cast<ssize_t>( total_size ) ) {
+    throw runtime_error( "read() read more than requested" );
+  }
+
+  return bytes_read;
+}
+
 size_t FileDescriptor::write( string_view buffer )
 {
   return write( vector<string_view> { buffer } );
@@ -167,10 +208,13 @@ size_t FileDescriptor::write( const vector<Buffer>& buffers )
 
 size_t FileDescriptor::write( const vector<string_view>& buffers )
 {
+  // writev() accepts at most IOV_MAX buffers; the remainder is left for the next (partial) write
+  const size_t count = min( buffers.size(), static_cast<size_t>( IOV_MAX ) );
+
   vector<iovec> iovecs;
-  iovecs.reserve( buffers.size() );
+  iovecs.reserve( count );
   size_t total_size = 0;
-  for ( const auto x : buffers ) {
+  for ( const auto x : span( buffers ).first( count ) ) {
     iovecs.push_back( { const_cast<char*>( x.data() ), x.size() } ); // NOLINT(*-const-cast)
     total_size += x.size();
   }
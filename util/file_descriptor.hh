@@ -4,6 +4,7 @@
 #include <cstddef>
 #include <limits>
 #include <memory>
+#include <span>
 #include <vector>
 
 // A reference-counted handle to a file descriptor
@@ -48,6 +49,9 @@ protected:
   // size of buffer to allocate for read()
   static constexpr size_t kReadBufferSize = 16384;
 
+  // most caller-provided regions accepted by one read() into existing memory
+  static constexpr size_t kMaxReadRegions = 8;
+
   void set_eof() { internal_fd_->eof_ = true; }
   void register_read() { ++internal_fd_->read_count_; }   // increment read count
   void register_write() { ++internal_fd_->write_count_; } // increment write count
@@ -66,6 +70,10 @@ public:
   void read( std::string& buffer );
   void read( std::vector<std::string>& buffers );
 
+  // Read into existing memory (e.g. a ByteStream's free space) with one readv
+  // returns number of bytes read
+  size_t read( std::span<const std::span<char>> buffers );
+
   // Attempt to write a buffer
   // returns number of bytes written
   size_t write( std::string_view buffer );
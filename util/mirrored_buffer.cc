@@ -0,0 +1,101 @@
+#include "mirrored_buffer.hh"
+
+#include "exception.hh"
+
+#include <cstring>
+#include <iostream>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <utility>
+
+using namespace std;
+
+MirroredBuffer::MirroredBuffer( size_t min_size )
+{
+  if ( min_size == 0 ) {
+    return;
+  }
+
+  map( mapped_size( min_size ) );
+}
+
+size_t MirroredBuffer::mapped_size( size_t min_size )
+{
+  const auto page_size = static_cast<size_t>( CheckSystemCall( "sysconf", sysconf( _SC_PAGESIZE ) ) );
+  return ( min_size + page_size - 1 ) / page_size * page_size;
+}
+
+void MirroredBuffer::map( size_t size )
+{
+  const int fd = CheckSystemCall( "memfd_create", memfd_create( "minnow-mirrored-buffer", MFD_CLOEXEC ) );
+
+  try {
+    CheckSystemCall( "ftruncate", ftruncate( fd, static_cast<off_t>( size ) ) );
+
+    // reserve twice the address space, then map the same file over both halves
+    void* base = mmap( nullptr, 2 * size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+    if ( base == MAP_FAILED ) {
+      throw unix_error { "mmap" };
+    }
+
+    auto* const first = static_cast<char*>( base );
+    for ( char* half : { first, first + size } ) {
+      if ( mmap( half, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0 ) == MAP_FAILED ) {
+        const unix_error error { "mmap" };
+        munmap( base, 2 * size );
+        throw error;
+      }
+    }
+
+    data_ = first;
+    size_ = size;
+  } catch ( ... ) {
+    ::close( fd );
+    throw;
+  }
+
+  // the mappings keep the memory alive
+  CheckSystemCall( "close", ::close( fd ) );
+}
+
+void MirroredBuffer::unmap()
+{
+  if ( data_ and munmap( data_, 2 * size_ ) < 0 ) {
+    // don't throw an exception from the destructor
+    cerr << "Exception destructing MirroredBuffer: " << unix_error { "munmap" }.what() << endl;
+  }
+
+  data_ = nullptr;
+  size_ = 0;
+}
+
+MirroredBuffer::MirroredBuffer( const MirroredBuffer& other )
+{
+  if ( other.size_ ) {
+    map( other.size_ );
+    memcpy( data_, other.data_, size_ );
+  }
+}
+
+MirroredBuffer& MirroredBuffer::operator=( const MirroredBuffer& other )
+{
+  if ( this != &other ) {
+    MirroredBuffer copy { other };
+    *this = move( copy );
+  }
+  return *this;
+}
+
+MirroredBuffer::MirroredBuffer( MirroredBuffer&& other ) noexcept
+  : data_( exchange( other.data_, nullptr ) ), size_( exchange( other.size_, 0 ) )
+{}
+
+MirroredBuffer& MirroredBuffer::operator=( MirroredBuffer&& other ) noexcept
+{
+  if ( this != &other ) {
+    unmap();
+    data_ = exchange( other.data_, nullptr );
+    size_ = exchange( other.size_, 0 );
+  }
+  return *this;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+
+// A ring buffer's memory mapped twice back-to-back, so that data()[i] and data()[i + size()]
+// are the same byte: any run of up to size() bytes starting inside the buffer is contiguous,
+// even when it wraps around the end.
+class MirroredBuffer
+{
+  char* data_ {};  // Start of the first of the two mappings
+  size_t size_ {}; // Length of one mapping (a multiple of the page size)
+
+  void map( size_t size );
+  void unmap();
+
+public:
+  MirroredBuffer() = default;
+
+  // Map at least `min_size` bytes (rounded up to a whole number of pages)
+  explicit MirroredBuffer( size_t min_size );
+
+  // Length of one mapping for at least `min_size` bytes
+  static size_t mapped_size( size_t min_size );
+
+  ~MirroredBuffer() { unmap(); }
+
+  // Copies get their own mapping with the same contents
+  MirroredBuffer( const MirroredBuffer& other );
+  MirroredBuffer& operator=( const MirroredBuffer& other );
+  MirroredBuffer( MirroredBuffer&& other ) noexcept;
+  MirroredBuffer& operator=( MirroredBuffer&& other ) noexcept;
+
+  char* data() { return data_; }
+  const char* data() const { return data_; }
+  size_t size() const { return size_; }
+};
@@ -0,0 +1,140 @@
+#include "spsc_channel.hh"
+
+#include "exception.hh"
+
+#include <algorithm>
+#include <poll.h>
+#include <sys/eventfd.h>
+
+using namespace std;
+
+//! \param[in] capacity is the size of the ring, in bytes
+SPSCChannel::SPSCChannel( uint64_t capacity )
+  : buffer_( capacity, '\0' )
+  , capacity_( capacity )
+  , readable_( CheckSystemCall( "eventfd", ::eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC ) ) )
+  , writable_( CheckSystemCall( "eventfd", ::eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC ) ) )
+{
+  if ( capacity == 0 ) {
+    throw runtime_error( "SPSCChannel capacity must be positive" );
+  }
+}
+
+void SPSCChannel::signal( FileDescriptor& event )
+{
+  const uint64_t one = 1;
+  event.write( { reinterpret_cast<const char*>( &one ), sizeof( one ) } ); // NOLINT(*-reinterpret-cast)
+}
+
+void SPSCChannel::clear( FileDescriptor& event )
+{
+  string counter( sizeof( uint64_t ), '\0' );
+  event.read( counter );
+}
+
+void SPSCChannel::wait( FileDescriptor& event )
+{
+  pollfd pfd { event.fd_num(), POLLIN, 0 };
+  CheckSystemCall( "poll", ::poll( &pfd, 1, -1 ) );
+  clear( event );
+}
+
+size_t SPSCChannel::write( string_view data )
+{
+  const uint64_t tail = bytes_written_.load( memory_order_relaxed );
+  const uint64_t len = min<uint64_t>( data.size(), capacity_ - ( tail - bytes_read_.load( memory_order_acquire ) ) );
+
+  if ( len == 0 ) {
+    return 0;
+  }
+
+  const uint64_t offset = tail % capacity_;
+  const uint64_t first_len = min( len, capacity_ - offset );
+  data.copy( buffer_.data() + offset, first_len );
+  data.copy( buffer_.data(), len - first_len, first_len );
+
+  // Publish, then check whether the consumer had drained everything (and so may be asleep).
+  // Both sides use seq_cst so at least one of them sees the other's update.
+  bytes_written_.store( tail + len );
+  if ( bytes_read_.load() == tail ) {
+    signal( readable_ );
+  }
+
+  return len;
+}
+
+size_t SPSCChannel::write_from( Reader& reader )
+{
+  size_t total = 0;
+  for ( const auto region : reader.peek_all() ) {
+    const size_t len = write( region );
+    total += len;
+    if ( len < region.size() ) {
+      break;
+    }
+  }
+
+  reader.pop( total );
+  return total;
+}
+
+void SPSCChannel::close()
+{
+  writer_closed_ = true;
+  signal( readable_ );
+}
+
+void SPSCChannel::wait_writable()
+{
+  while ( available_capacity() == 0 and not reader_closed_ ) {
+    wait( writable_ );
+  }
+}
+
+size_t SPSCChannel::read( span<char> out )
+{
+  const uint64_t head = bytes_read_.load( memory_order_relaxed );
+  const uint64_t len = min<uint64_t>( out.size(), bytes_written_.load( memory_order_acquire ) - head );
+
+  if ( len == 0 ) {
+    return 0;
+  }
+
+  const uint64_t offset = head % capacity_;
+  const uint64_t first_len = min( len, capacity_ - offset );
+  const string_view ring { buffer_ };
+  ring.copy( out.data(), first_len, offset );
+  ring.copy( out.data() + first_len, len - first_len, 0 );
+
+  // Release the space, then check whether the ring was full (so the producer may be asleep)
+  bytes_read_.store( head + len );
+  if ( bytes_written_.load() - head == capacity_ ) {
+    signal( writable_ );
+  }
+
+  return len;
+}
+
+size_t SPSCChannel::read_into( Writer& writer )
+{
+  size_t total = 0;
+  for ( const auto region : writer.reserve( bytes_buffered() ) ) {
+    total += read( region );
+  }
+
+  writer.commit( total );
+  return total;
+}
+
+void SPSCChannel::close_read()
+{
+  reader_closed_ = true;
+  signal( writable_ );
+}
+
+void SPSCChannel::wait_readable()
+{
+  while ( bytes_buffered() == 0 and not writer_closed_ ) {
+    wait( readable_ );
+  }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "byte_stream.hh"
+#include "file_descriptor.hh"
+
+#include <atomic>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+//! Lock-free single-producer/single-consumer byte ring shared between two threads
+//! \details One thread only writes (and closes), the other only reads. Bytes are copied
+//! straight between the ring and the caller's memory; the only system calls are eventfd
+//! wakeups, and those happen only when the other side may be asleep (the ring just became
+//! non-empty, or just stopped being full).
+class SPSCChannel
+{
+  std::string buffer_; //!< Ring storage
+  uint64_t capacity_;  //!< Size of the ring
+
+  alignas( 64 ) std::atomic<uint64_t> bytes_written_ { 0 }; //!< Advanced only by the producer
+  alignas( 64 ) std::atomic<uint64_t> bytes_read_ { 0 };    //!< Advanced only by the consumer
+
+  std::atomic_bool writer_closed_ { false }; //!< Producer will write nothing more
+  std::atomic_bool reader_closed_ { false }; //!< Consumer will read nothing more
+
+  FileDescriptor readable_; //!< eventfd the producer signals when the consumer may be waiting for data
+  FileDescriptor writable_; //!< eventfd the consumer signals when the producer may be waiting for space
+
+  static void signal( FileDescriptor& event );
+  static void wait( FileDescriptor& event );
+
+public:
+  //! Allocate a ring of `capacity` bytes and its two eventfds
+  explicit SPSCChannel( uint64_t capacity );
+
+  //! \name Producer side
+  //!@{
+  size_t write( std::string_view data ); //!< Copy as much of `data` as fits; returns bytes written
+  size_t write_from( Reader& reader );   //!< Move as many of `reader`'s buffered bytes as fit
+  void close();                          //!< Signal that nothing more will be written
+  void wait_writable();                  //!< Block until there is free space or the consumer has closed
+  bool reader_closed() const { return reader_closed_; }
+  FileDescriptor& writable_event() { return writable_; } //!< Becomes readable when space may have opened up
+  //!@}
+
+  //! \name Consumer side
+  //!@{
+  size_t read( std::span<char> out ); //!< Copy up to `out.size()` buffered bytes; returns bytes read
+  size_t read_into( Writer& writer ); //!< Move as many buffered bytes as fit into `writer`'s free space
+  void close_read();                  //!< Signal that nothing more will be read
+  void wait_readable();               //!< Block until there is data or the producer has closed
+  bool is_finished() const { return writer_closed_ and bytes_buffered() == 0; }
+  FileDescriptor& readable_event() { return readable_; } //!< Becomes readable when data may have arrived
+  //!@}
+
+  uint64_t bytes_buffered() const { return bytes_written_ - bytes_read_; }
+  uint64_t available_capacity() const { return capacity_ - bytes_buffered(); }
+
+  //! Clear a pending wakeup on `readable_event()` or `writable_event()`
+  static void clear( FileDescriptor& event );
+
+  //! Shared between threads, so it can be neither copied nor moved
+  //!@{
+  SPSCChannel( const SPSCChannel& ) = delete;
+  SPSCChannel& operator=( const SPSCChannel& ) = delete;
+  SPSCChannel( SPSCChannel&& ) = delete;
+  SPSCChannel& operator=( SPSCChannel&& ) = delete;
+  ~SPSCChannel() = default;
+  //!@}
+};
@@ -1,10 +1,14 @@
 #pragma once
 
 #include "address.hh"
+#include "byte_stream.hh"
+#include "congestion_control.hh"
+#include "reassembly_budget.hh"
 #include "wrapping_integers.hh"
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <optional>
 
 //! Config for TCP sender and receiver
@@ -13,13 +17,63 @@ class TCPConfig
 public:
   static constexpr size_t DEFAULT_CAPACITY = 64000; //!< Default capacity
   static constexpr size_t MAX_PAYLOAD_SIZE = 1000;  //!< Conservative max payload size for real Internet
+  static constexpr uint16_t PEER_MSS_DFLT = 536;    //!< Peer MSS assumed if its SYN has no MSS option (RFC 9293)
   static constexpr uint16_t TIMEOUT_DFLT = 1000;    //!< Default re-transmit timeout is 1 second
   static constexpr unsigned MAX_RETX_ATTEMPTS = 8;  //!< Maximum re-transmit attempts before giving up
+  static constexpr unsigned DUPACK_THRESHOLD = 3;   //!< Duplicate ACKs that trigger a fast retransmit
 
   uint16_t rt_timeout = TIMEOUT_DFLT;      //!< Initial value of the retransmission timeout, in milliseconds
+
+  //! Derive the retransmission timeout from measured RTTs (RFC 6298) within [rto_min, rto_max], in milliseconds,
+  //! instead of returning to rt_timeout after every acknowledgment
+  bool rtt_estimation = false;
+  uint16_t rto_min = 200;
+  uint16_t rto_max = 60000;
   size_t recv_capacity = DEFAULT_CAPACITY; //!< Receive capacity, in bytes
   size_t send_capacity = DEFAULT_CAPACITY; //!< Sender capacity, in bytes
   std::optional<Wrap32> fixed_isn {};
+
+  //! Congestion control algorithm limiting the sender on top of the peer's window (none by default)
+  CongestionControl::Algorithm congestion_control = CongestionControl::Algorithm::None;
+
+  //! Fast retransmit and fast recovery (RFC 5681 3.2, RFC 6582): resend the earliest outstanding segment on
+  //! DUPACK_THRESHOLD duplicate ACKs instead of waiting for the retransmission timer
+  bool fast_retransmit = false;
+
+  //! Delayed ACK: hold back a pure ACK for up to this long, or until two full-sized segments have
+  //! arrived (0 = ACK every segment right away). Out-of-order data and SYN/FIN are always ACKed at once.
+  uint16_t delayed_ack_ms = 0;
+  //! Offer SACK on the SYN; if the peer offers it too, report held data in SACK blocks, and keep a scoreboard
+  //! of the peer's so that only the holes are resent (RFC 6675, after a timeout or with fast_retransmit)
+  bool sack = false;
+
+  //! Offer window scaling (RFC 7323) on the SYN, so a recv_capacity beyond 64 KiB can be advertised in full
+  bool window_scale = false;
+
+  //! Largest payload to receive in one segment, offered in the MSS option on the SYN. Segments sent, options
+  //! included, are no larger than this nor than the peer's MSS (e.g. 1460 for a 1500-byte MTU, 8960 for
+  //! 9000-byte jumbo frames).
+  uint16_t mss = MAX_PAYLOAD_SIZE;
+
+  //! Path MTU discovery (RFC 8899): send MAX_PAYLOAD_SIZE-byte segments at first, and probe for the largest
+  //! size up to the negotiated MSS that the path carries
+  bool plpmtud = false;
+
+  //! Nagle's algorithm (RFC 896, RFC 1122 4.2.3.4): while anything sent is unacknowledged, hold back a tail of
+  //! the outbound stream smaller than a segment until it fills one, the stream is closed, or everything is ACKed
+  bool nagle = false;
+
+  //! Receive-buffer autotuning: starting from recv_capacity, resize the inbound stream within
+  //! [recv_capacity_min, recv_capacity_max] to what the application reads per round trip
+  bool recv_autotune = false;
+  size_t recv_capacity_min = 4 * MAX_PAYLOAD_SIZE;
+  size_t recv_capacity_max = 4 * 1024 * 1024;
+
+  //! Cap on out-of-order bytes held, shared by every connection given the same budget (no cap if empty)
+  std::shared_ptr<ReassemblyBudget> reassembly_budget {};
+
+  //! Storage mode of the inbound and outbound streams (Chunked hands pushed strings to the reader without copying)
+  ByteStream::Storage stream_storage = ByteStream::Storage::Ring;
 };
 
 //! Config for classes derived from FdAdapter
@@ -49,6 +49,8 @@ void TCPMinnowSocket<AdaptT>::_tcp_loop( const function<bool()>& condition )
       _datagram_adapter.tick( next_time - base_time );
       base_time = next_time;
     }
+
+    _pump_shared_channels();
   }
 }
 
@@ -108,16 +110,54 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP( const TCPConfig& config )
     },
     [&] { return _tcp->active(); } );
 
+  if ( _outbound_channel.has_value() ) {
+    // rules 2 and 3 with the shared-memory transport: the bytes themselves are moved by
+    // _pump_shared_channels() on every pass of the loop; these rules only wake the loop up
+    _eventloop.add_rule(
+      "wake on bytes from owner",
+      _outbound_channel->readable_event(),
+      Direction::In,
+      [&] { SPSCChannel::clear( _outbound_channel->readable_event() ); },
+      [&] { return _tcp->active() and not _outbound_shutdown; } );
+
+    _eventloop.add_rule(
+      "wake on space for owner",
+      _inbound_channel->writable_event(),
+      Direction::In,
+      [&] { SPSCChannel::clear( _inbound_channel->writable_event() ); },
+      [&] { return not _inbound_shutdown; } );
+  } else {
+    _add_socket_pair_rules();
+  }
+
+  // rule 4: read outbound segments from TCPConnection and send as datagrams
+  _eventloop.add_rule(
+    "send TCP segment",
+    _datagram_adapter.fd(),
+    Direction::Out,
+    [&] {
+      while ( not outgoing_segments_.empty() ) {
+        _datagram_adapter.write( outgoing_segments_.front() );
+        outgoing_segments_.pop();
+      }
+    },
+    [&] { return not outgoing_segments_.empty(); } );
+}
+
+template<typename AdaptT>
+void TCPMinnowSocket<AdaptT>::_add_socket_pair_rules()
+{
+  // the interest of rules 2 and 3 follows the streams' watermarks instead of re-checking them every iteration
+  _tcp->outbound_writer().on_writable( 1, [&]( bool ready ) { _outbound_writable = ready; } );
+  _tcp->inbound_reader().on_readable( 1, [&]( bool ready ) { _inbound_readable = ready; } );
+
   // rule 2: read from pipe into outbound buffer
   _eventloop.add_rule(
     "push bytes to TCPPeer",
     _thread_data,
     Direction::In,
     [&] {
-      string data;
-      data.resize( _tcp->outbound_writer().available_capacity() );
-      _thread_data.read( data );
-      _tcp->outbound_writer().push( move( data ) );
+      _tcp->outbound_writer().push_from( _thread_data );
 
       if ( _thread_data.eof() ) {
         _tcp->outbound_writer().close();
@@ -132,10 +172,7 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP( const TCPConfig& config )
       _tcp->push();
       collect_segments();
     },
-    [&] {
-      return ( _tcp->active() ) and ( not _outbound_shutdown )
-             and ( _tcp->outbound_writer().available_capacity() > 0 );
-    },
+    [&] { return ( _tcp->active() ) and ( not _outbound_shutdown ) and _outbound_writable; },
     [&] {
       _tcp->outbound_writer().close();
       _outbound_shutdown = true;
@@ -148,12 +185,11 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP( const TCPConfig& config )
     Direction::Out,
     [&] {
       Reader& inbound = _tcp->inbound_reader();
-      // Write from the inbound_stream into
-      // the pipe, handling the possibility of a partial
+      // Write every buffered region of the inbound_stream into
+      // the pipe with one writev, handling the possibility of a partial
       // write (i.e., only pop what was actually written).
       if ( inbound.bytes_buffered() ) {
-        const std::string_view buffer = inbound.peek();
-        const auto bytes_written = _thread_data.write( buffer );
+        const auto bytes_written = _thread_data.write( inbound.peek_all() );
         inbound.pop( bytes_written );
       }
 
@@ -166,24 +202,7 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP( const TCPConfig& config )
              << ( inbound.has_error() ? "with an error/reset.\n" : "cleanly.\n" );
       }
     },
-    [&] {
-      return _tcp->inbound_reader().bytes_buffered()
-             or ( ( _tcp->inbound_reader().is_finished() or _tcp->inbound_reader().has_error() )
-                  and not _inbound_shutdown );
-    } );
-
-  // rule 4: read outbound segments from TCPConnection and send as datagrams
-  _eventloop.add_rule(
-    "send TCP segment",
-    _datagram_adapter.fd(),
-    Direction::Out,
-    [&] {
-      while ( not outgoing_segments_.empty() ) {
-        _datagram_adapter.write( outgoing_segments_.front() );
-        outgoing_segments_.pop();
-      }
-    },
-    [&] { return not outgoing_segments_.empty(); } );
+    [&] { return _inbound_readable and not _inbound_shutdown; } );
 }
 
 //! \brief Call [socketpair](\ref man2::socketpair) and return connected Unix-domain sockets of specified type
@@ -221,6 +240,10 @@ template<typename AdaptT>
 void TCPMinnowSocket<AdaptT>::wait_until_closed()
 {
   shutdown( SHUT_RDWR );
+  if ( _outbound_channel.has_value() ) {
+    _outbound_channel->close();
+    _inbound_channel->close_read();
+  }
   if ( _tcp_thread.joinable() ) {
     cerr << "DEBUG: Waiting for clean shutdown... ";
     _tcp_thread.join();
@@ -294,6 +317,10 @@ void TCPMinnowSocket<AdaptT>::_tcp_main()
     }
     _tcp_loop( [] { return true; } );
     shutdown( SHUT_RDWR );
+    if ( _outbound_channel.has_value() ) {
+      _outbound_channel->close_read();
+      _inbound_channel->close();
+    }
     if ( not _tcp.value().active() ) {
       cerr << "DEBUG: TCP connection finished "
            << ( _tcp->inbound_reader().has_error() ? "uncleanly.\n" : "cleanly.\n" );
@@ -317,6 +344,104 @@ void TCPMinnowSocket<AdaptT>::collect_segments()
   }
 }
 
+template<typename AdaptT>
+void TCPMinnowSocket<AdaptT>::_pump_shared_channels()
+{
+  if ( not _outbound_channel.has_value() or not _tcp.has_value() ) {
+    return;
+  }
+
+  // owner -> outbound stream
+  if ( _tcp->active() and not _outbound_shutdown ) {
+    const bool pushed = _outbound_channel->read_into( _tcp->outbound_writer() ) > 0;
+
+    if ( _outbound_channel->is_finished() ) {
+      _tcp->outbound_writer().close();
+      _outbound_shutdown = true;
+
+      // debugging output:
+      cerr << "DEBUG: Outbound stream to " << _datagram_adapter.config().destination.to_string() << " finished ("
+           << _tcp.value().sender().sequence_numbers_in_flight() << " seqno"
+           << ( _tcp.value().sender().sequence_numbers_in_flight() == 1 ? "" : "s" ) << " still in flight).\n";
+    }
+
+    if ( pushed or _outbound_shutdown ) {
+      _tcp->push();
+      collect_segments();
+    }
+  }
+
+  // inbound stream -> owner
+  if ( not _inbound_shutdown ) {
+    Reader& inbound = _tcp->inbound_reader();
+    _inbound_channel->write_from( inbound );
+
+    if ( inbound.is_finished() or inbound.has_error() ) {
+      _inbound_channel->close();
+      _inbound_shutdown = true;
+
+      // debugging output:
+      cerr << "DEBUG: Inbound stream from " << _datagram_adapter.config().destination.to_string() << " finished "
+           << ( inbound.has_error() ? "with an error/reset.\n" : "cleanly.\n" );
+    }
+  }
+}
+
+//! \param[in] capacity is the size of each of the two rings, in bytes
+template<typename AdaptT>
+void TCPMinnowSocket<AdaptT>::use_shared_memory_transport( uint64_t capacity )
+{
+  if ( _tcp ) {
+    throw runtime_error( "use_shared_memory_transport() after the TCPPeer was initialized" );
+  }
+
+  _outbound_channel.emplace( capacity );
+  _inbound_channel.emplace( capacity );
+}
+
+template<typename AdaptT>
+size_t TCPMinnowSocket<AdaptT>::write_shared( string_view data )
+{
+  if ( not _outbound_channel.has_value() ) {
+    throw runtime_error( "write_shared() without the shared-memory transport" );
+  }
+
+  size_t total = 0;
+  while ( true ) {
+    total += _outbound_channel->write( data.substr( total ) );
+    if ( total == data.size() ) {
+      break;
+    }
+    if ( _outbound_channel->reader_closed() ) {
+      throw runtime_error( "write_shared() after the TCP connection finished" );
+    }
+    _outbound_channel->wait_writable();
+  }
+
+  return total;
+}
+
+template<typename AdaptT>
+size_t TCPMinnowSocket<AdaptT>::read_shared( span<char> buffer )
+{
+  if ( not _inbound_channel.has_value() ) {
+    throw runtime_error( "read_shared() without the shared-memory transport" );
+  }
+
+  _inbound_channel->wait_readable();
+  return _inbound_channel->read( buffer );
+}
+
+template<typename AdaptT>
+void TCPMinnowSocket<AdaptT>::shutdown_shared_write()
+{
+  if ( not _outbound_channel.has_value() ) {
+    throw runtime_error( "shutdown_shared_write() without the shared-memory transport" );
+  }
+
+  _outbound_channel->close();
+}
+
 //! Specialization of TCPMinnowSocket for TCPOverIPv4OverTunFdAdapter
 template class TCPMinnowSocket<TCPOverIPv4OverTunFdAdapter>;
 
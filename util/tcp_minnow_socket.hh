@@ -5,6 +5,7 @@
 #include "file_descriptor.hh"
 #include "network_interface.hh"
 #include "socket.hh"
+#include "spsc_channel.hh"
 #include "tcp_config.hh"
 #include "tcp_peer.hh"
 #include "tuntap_adapter.hh"
@@ -12,6 +13,8 @@
 #include <atomic>
 #include <cstdint>
 #include <optional>
+#include <span>
+#include <string_view>
 #include <thread>
 #include <vector>
 
@@ -31,6 +34,9 @@ private:
   //! Set up the TCPPeer and the event loop
   void _initialize_TCP( const TCPConfig& config );
 
+  //! Add the rules that move application bytes over the _thread_data socket pair
+  void _add_socket_pair_rules();
+
   //! TCP state machine
   std::optional<TCPPeer> _tcp {};
 
@@ -60,8 +66,22 @@ private:
 
   bool _fully_acked { false }; //!< Has the outbound data been fully acknowledged by the peer?
 
+  bool _outbound_writable { false }; //!< Does the outbound stream have room? (tracked by its watermark)
+
+  bool _inbound_readable { false }; //!< Does the inbound stream have bytes or an ending? (tracked by its watermark)
+
   void collect_segments(); //!< Drain segments from the TCPPeer
 
+  //! \name
+  //! Shared-memory transport: rings between the owner and TCPPeer threads in place of _thread_data
+
+  //!@{
+  std::optional<SPSCChannel> _outbound_channel {}; //!< Owner -> TCPPeer outbound stream
+  std::optional<SPSCChannel> _inbound_channel {};  //!< TCPPeer inbound stream -> owner
+
+  void _pump_shared_channels(); //!< Move bytes between the rings and the TCPPeer's streams
+  //!@}
+
 public:
   //! Construct from the interface that the TCPPeer thread will use to read and write datagrams
   explicit TCPMinnowSocket( AdaptT&& datagram_interface );
@@ -80,6 +100,24 @@ public:
   //! When a connected socket is destructed, it will send a RST
   ~TCPMinnowSocket();
 
+  //! \name
+  //! Alternative to reading and writing the socket: application bytes cross lock-free rings shared with
+  //! the TCPPeer thread, so they are copied straight into (and out of) its streams without system calls.
+
+  //!@{
+  //! Use the shared-memory transport; must be called before connect() or listen_and_accept()
+  void use_shared_memory_transport( uint64_t capacity = TCPConfig::DEFAULT_CAPACITY );
+
+  //! Write all of `data` to the outbound stream, blocking while the ring is full; returns bytes written
+  size_t write_shared( std::string_view data );
+
+  //! Block until inbound bytes are available, then read up to `buffer.size()`; returns 0 at EOF
+  size_t read_shared( std::span<char> buffer );
+
+  //! Signal that the owner will write nothing more
+  void shutdown_shared_write();
+  //!@}
+
   //! \name
   //! This object cannot be safely moved or copied, since it is in use by two threads simultaneously
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "receive_buffer_tuner.hh"
 #include "tcp_config.hh"
 #include "tcp_receiver.hh"
 #include "tcp_receiver_message.hh"
@@ -7,18 +8,53 @@
 #include "tcp_sender.hh"
 #include "tcp_sender_message.hh"
 
+#include <algorithm>
+#include <cstdint>
 #include <optional>
 
 class TCPPeer
 {
   TCPConfig cfg_;
-  TCPSender sender_ { cfg_.rt_timeout, cfg_.fixed_isn };
+  TCPSender sender_ { cfg_ };
   TCPReceiver receiver_ {};
-  Reassembler reassembler_ {};
+  Reassembler reassembler_ { cfg_.reassembly_budget };
 
-  ByteStream outbound_stream_ { cfg_.send_capacity }, inbound_stream_ { cfg_.recv_capacity };
+  ByteStream outbound_stream_ { cfg_.send_capacity, cfg_.stream_storage };
+  ByteStream inbound_stream_ { cfg_.recv_capacity, cfg_.stream_storage };
+
+  std::optional<ReceiveBufferTuner> recv_tuner_ {
+    cfg_.recv_autotune ? std::make_optional<ReceiveBufferTuner>( cfg_.recv_capacity_min, cfg_.recv_capacity_max )
+                       : std::nullopt };
 
   bool need_send_ {};
+  bool peer_sack_permitted_ {}; // the peer's SYN offered SACK
+  std::optional<uint8_t> peer_window_scale_ {}; // the shift the peer's SYN offered, if any
+
+  // Largest payload the peer has sent so far: what a full-sized segment is
+  uint64_t receive_mss_ { std::min<uint64_t>( TCPConfig::MAX_PAYLOAD_SIZE, cfg_.mss ) };
+
+  // Delayed ACK (cfg_.delayed_ack_ms > 0)
+  uint64_t unacked_bytes_ {};               // payload received since our last segment went out
+  std::optional<uint64_t> ack_timer_ms_ {}; // time left before a held-back ACK must be sent
+
+  uint64_t window_edge_ {}; // stream index up to which our last segment allowed the peer to send
+
+  uint64_t window_edge() const
+  {
+    return inbound_stream_.writer().bytes_pushed() + inbound_stream_.writer().available_capacity();
+  }
+
+  // Smallest shift that lets the advertised window cover the largest receive capacity
+  uint8_t window_scale() const
+  {
+    const uint64_t capacity
+      = cfg_.recv_autotune ? std::max( cfg_.recv_capacity, cfg_.recv_capacity_max ) : cfg_.recv_capacity;
+    uint8_t shift = 0;
+    while ( shift < TCPReceiverMessage::MAX_WINDOW_SCALE and ( capacity >> shift ) > UINT16_MAX ) {
+      ++shift;
+    }
+    return shift;
+  }
 
 public:
   explicit TCPPeer( const TCPConfig& cfg ) : cfg_( cfg ) {}
@@ -27,7 +63,27 @@ public:
   Reader& inbound_reader() { return inbound_stream_.reader(); }
 
   void push() { sender_.push( outbound_stream_.reader() ); };
-  void tick( uint64_t ms_since_last_tick ) { sender_.tick( ms_since_last_tick ); }
+
+  // Hold back segments smaller than a full one (like TCP_CORK) until uncork(), which sends what was written
+  void cork() { sender_.cork(); }
+  void uncork() { sender_.uncork( outbound_stream_.reader() ); }
+  void tick( uint64_t ms_since_last_tick )
+  {
+    sender_.tick( ms_since_last_tick );
+
+    if ( recv_tuner_.has_value() ) {
+      recv_tuner_->tick( ms_since_last_tick, inbound_stream_ );
+    }
+
+    if ( ack_timer_ms_.has_value() ) {
+      if ( ms_since_last_tick >= ack_timer_ms_.value() ) {
+        need_send_ = true;
+        ack_timer_ms_.reset();
+      } else {
+        ack_timer_ms_.value() -= ms_since_last_tick;
+      }
+    }
+  }
 
   bool has_ackno() const { return receiver_.send( inbound_stream_.writer() ).ackno.has_value(); }
 
@@ -47,20 +103,60 @@ public:
       return;
     }
 
+    if ( seg.sender_message.SYN ) {
+      peer_sack_permitted_ = seg.receiver_message.sack_permitted;
+      peer_window_scale_ = seg.receiver_message.window_scale;
+      if ( cfg_.sack and peer_sack_permitted_ ) {
+        sender_.use_sack();
+      }
+      sender_.set_peer_mss( seg.receiver_message.mss.value_or( TCPConfig::PEER_MSS_DFLT ) );
+    }
+
     // Give incoming TCPReceiverMessage to sender.
-    sender_.receive( seg.receiver_message );
+    sender_.receive( seg.receiver_message, seg.sender_message.sequence_length() );
+
+    // The window on a SYN is never scaled; once both sides have offered window scaling, every later one is.
+    if ( seg.sender_message.SYN and cfg_.window_scale and peer_window_scale_.has_value() ) {
+      sender_.set_window_scale( std::min( peer_window_scale_.value(), TCPReceiverMessage::MAX_WINDOW_SCALE ) );
+      receiver_.set_window_scale( window_scale() );
+    }
 
     // Give incoming TCPSenderMessage to receiver.
     // If SenderMessage is non-empty or a keep-alive, make sure to reply.
-    need_send_ |= ( seg.sender_message.sequence_length() > 0 );
     const auto our_ackno = receiver_.send( inbound_stream_.writer() ).ackno;
     need_send_ |= ( our_ackno.has_value() and seg.sender_message.seqno + 1 == our_ackno.value() );
 
+    const bool occupies_seqnos = seg.sender_message.sequence_length() > 0;
+    const bool in_order = our_ackno.has_value() and seg.sender_message.seqno == our_ackno.value();
+    const bool syn_or_fin = seg.sender_message.SYN or seg.sender_message.FIN;
+    const bool had_holes = reassembler_.bytes_pending() > 0;
+    unacked_bytes_ += seg.sender_message.payload.size();
+    receive_mss_ = std::max<uint64_t>( receive_mss_, seg.sender_message.payload.size() );
+
     receiver_.receive( std::move( seg.sender_message ), reassembler_, inbound_stream_.writer() );
+
+    if ( recv_tuner_.has_value() and occupies_seqnos ) {
+      recv_tuner_->on_receive( inbound_stream_ );
+    }
+
+    if ( occupies_seqnos ) {
+      // ACK at once unless this is plain in-order data and fewer than two full segments are unacknowledged
+      const bool ack_now = cfg_.delayed_ack_ms == 0 or not in_order or syn_or_fin or had_holes
+                           or reassembler_.bytes_pending() > 0 or unacked_bytes_ >= 2 * receive_mss_;
+      if ( ack_now ) {
+        need_send_ = true;
+      } else if ( not ack_timer_ms_.has_value() ) {
+        ack_timer_ms_ = cfg_.delayed_ack_ms;
+      }
+    }
   }
 
   std::optional<TCPSegment> maybe_send()
   {
+    if ( recv_tuner_.has_value() ) {
+      recv_tuner_->resize( inbound_stream_, window_edge_ );
+    }
+
     // Get outgoing TCPReceiverMessage from receiver.
     auto receiver_msg = receiver_.send( inbound_stream_.writer() );
 
@@ -72,14 +168,42 @@ public:
     // Get (possible) outgoing TCPSenderMessage, using empty message if we need to send something.
     auto sender_msg = sender_.maybe_send();
 
+    // Window update, when autotuning: once reading (or a larger buffer) has opened the window by a full segment
+    // or half the buffer, tell the peer (receiver-side silly window syndrome avoidance, RFC 1122 4.2.3.3).
+    // Otherwise the window is only updated on segments sent anyway, as the peer's data comes in.
+    if ( recv_tuner_.has_value() ) {
+      const uint64_t window_update_threshold = std::max<uint64_t>(
+        std::min<uint64_t>( receive_mss_, inbound_stream_.capacity() / 2 ), 1 );
+      need_send_ |= ( receiver_msg.ackno.has_value() and window_edge() >= window_edge_ + window_update_threshold );
+    }
+
     if ( need_send_ and not sender_msg.has_value() ) {
       sender_msg = sender_.send_empty_message();
     }
 
     need_send_ = false;
 
-    // Send the segment
+    // Offer SACK on our SYN; once both sides have, tell the sender what we hold beyond the ackno.
+    // Offer window scaling on our SYN too (answering a SYN only if it offered it), with an unscaled window,
+    // and tell the peer how large a segment we take.
+    if ( sender_msg.has_value() and sender_msg->SYN ) {
+      receiver_msg.mss = cfg_.mss;
+      receiver_msg.sack_permitted = cfg_.sack;
+      if ( cfg_.window_scale and ( not receiver_msg.ackno.has_value() or peer_window_scale_.has_value() ) ) {
+        receiver_msg.window_scale = window_scale();
+      }
+      receiver_msg.window_size
+        = static_cast<uint16_t>( std::min<uint64_t>( inbound_stream_.writer().available_capacity(), UINT16_MAX ) );
+    }
+    if ( cfg_.sack and peer_sack_permitted_ ) {
+      receiver_msg.sack = receiver_.sack_blocks( reassembler_ );
+    }
+
+    // Send the segment (which carries any ACK we were holding back)
     if ( sender_msg.has_value() ) {
+      unacked_bytes_ = 0;
+      ack_timer_ms_.reset();
+      window_edge_ = std::max( window_edge_, window_edge() );
       return TCPSegment {
         sender_msg.value(), receiver_msg, outbound_stream_.reader().has_error() or inbound_reader().has_error() };
     }
@@ -91,4 +215,6 @@ public:
   const TCPReceiver& receiver() const { return receiver_; }
   const TCPSender& sender() const { return sender_; }
   const Reassembler& reassembler() const { return reassembler_; }
+  const std::optional<ReceiveBufferTuner>& recv_tuner() const { return recv_tuner_; }
+  uint64_t advertised_window_edge() const { return window_edge_; }
 };
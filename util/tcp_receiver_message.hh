@@ -2,23 +2,54 @@
 
 #include "wrapping_integers.hh"
 
+#include <cstddef>
+#include <cstdint>
 #include <optional>
+#include <vector>
+
+/*
+ * A SACK block (RFC 2018): the receiver holds the sequence numbers [left, right), beyond a gap after the ackno.
+ */
+struct SACKBlock
+{
+  Wrap32 left;
+  Wrap32 right;
+};
 
 /*
  * The TCPReceiverMessage structure contains the information sent from a TCP receiver to its sender.
  *
- * It contains two fields:
+ * It contains six fields:
  *
  * 1) The acknowledgment number (ackno): the *next* sequence number needed by the TCP Receiver.
  *    This is an optional field that is empty if the TCPReceiver hasn't yet received the Initial Sequence Number.
  *
  * 2) The window size. This is the number of sequence numbers that the TCP receiver is interested
  *    to receive, starting from the ackno if present. The maximum value is 65,535 (UINT16_MAX from
- *    the <cstdint> header).
+ *    the <cstdint> header). Once window scaling is in effect, this is in units of 2^shift sequence
+ *    numbers, except on a segment that carries a SYN.
+ *
+ * 3) Whether the receiver understands SACK blocks. Only meaningful on a segment that carries a SYN.
+ *
+ * 4) Up to four SACK blocks, describing data the receiver holds beyond the ackno.
+ *
+ * 5) The window scale shift (RFC 7323) the receiver will apply to its window_size. Only meaningful on a
+ *    segment that carries a SYN, and only in effect once both sides have offered one.
+ *
+ * 6) The maximum segment size (MSS): the largest payload the receiver accepts in one segment. Only
+ *    meaningful on a segment that carries a SYN.
  */
 
 struct TCPReceiverMessage
 {
+  static constexpr size_t MAX_SACK_BLOCKS = 4;
+  static constexpr size_t SACK_OPTION_LENGTH = 4 + 8 * MAX_SACK_BLOCKS; // bytes, with the NOPs that align it
+  static constexpr uint8_t MAX_WINDOW_SCALE = 14; // RFC 7323 2.3
+
   std::optional<Wrap32> ackno {};
   uint16_t window_size {};
+  bool sack_permitted {};
+  std::vector<SACKBlock> sack {};
+  std::optional<uint8_t> window_scale {};
+  std::optional<uint16_t> mss {};
 };
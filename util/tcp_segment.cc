@@ -2,9 +2,19 @@
 #include "checksum.hh"
 #include "wrapping_integers.hh"
 
+#include <algorithm>
 #include <cstddef>
 
 static constexpr uint32_t TCPHeaderMinLen = 5; // 32-bit words
+static constexpr size_t TCPOptionsMaxLen = 40; // bytes, what the 4-bit data offset leaves
+
+// TCP option kinds
+static constexpr uint8_t TCPOptionEnd = 0;
+static constexpr uint8_t TCPOptionNOP = 1;
+static constexpr uint8_t TCPOptionMSS = 2;           // RFC 9293
+static constexpr uint8_t TCPOptionWindowScale = 3;   // RFC 7323
+static constexpr uint8_t TCPOptionSACKPermitted = 4; // RFC 2018
+static constexpr uint8_t TCPOptionSACK = 5;          // RFC 2018
 
 using namespace std;
 
@@ -52,34 +62,171 @@ void TCPSegment::parse( Parser& parser, uint32_t datagram_layer_pseudo_checksum
   parser.integer( udinfo.cksum );
   parser.integer( raw16 ); // urgent pointer
 
-  // skip any options or anything extra in the header
   if ( data_offset < TCPHeaderMinLen ) {
     parser.set_error();
+    return;
   }
-  parser.remove_prefix( data_offset * 4 - TCPHeaderMinLen * 4 );
+  parse_options( parser, data_offset * 4 - TCPHeaderMinLen * 4 );
 
   parser.all_remaining( sender_message.payload );
 }
 
+void TCPSegment::parse_options( Parser& parser, size_t len )
+{
+  while ( len > 0 and not parser.has_error() ) {
+    uint8_t kind {};
+    parser.integer( kind );
+    --len;
+
+    if ( kind == TCPOptionEnd ) {
+      break;
+    }
+    if ( kind == TCPOptionNOP ) {
+      continue;
+    }
+
+    uint8_t option_len {};
+    parser.integer( option_len );
+    if ( option_len < 2 or option_len - 1U > len ) {
+      parser.set_error();
+      return;
+    }
+    len -= option_len - 1U;
+    const size_t body_len = option_len - 2U;
+
+    switch ( kind ) {
+      case TCPOptionMSS:
+        if ( body_len != 2 ) {
+          parser.set_error();
+          return;
+        }
+        receiver_message.mss.emplace();
+        parser.integer( receiver_message.mss.value() );
+        break;
+
+      case TCPOptionWindowScale:
+        if ( body_len != 1 ) {
+          parser.set_error();
+          return;
+        }
+        receiver_message.window_scale.emplace();
+        parser.integer( receiver_message.window_scale.value() );
+        break;
+
+      case TCPOptionSACKPermitted:
+        receiver_message.sack_permitted = true;
+        parser.remove_prefix( body_len );
+        break;
+
+      case TCPOptionSACK:
+        if ( body_len % 8 ) {
+          parser.set_error();
+          return;
+        }
+        for ( size_t i = 0; i < body_len / 8; ++i ) {
+          uint32_t left {};
+          uint32_t right {};
+          parser.integer( left );
+          parser.integer( right );
+          receiver_message.sack.push_back( { Wrap32 { left }, Wrap32 { right } } );
+        }
+        break;
+
+      default: // skip options we don't understand
+        parser.remove_prefix( body_len );
+    }
+  }
+
+  // skip anything after the end of the option list
+  parser.remove_prefix( len );
+}
+
 class Wrap32Serializable : public Wrap32
 {
 public:
   uint32_t raw_value() const { return raw_value_; }
 };
 
+size_t TCPSegment::syn_options_length() const
+{
+  size_t len = 0;
+
+  // each option is preceded by NOPs to keep what follows 32-bit aligned
+  if ( sender_message.SYN and receiver_message.mss.has_value() ) {
+    len += 4;
+  }
+  if ( sender_message.SYN and receiver_message.window_scale.has_value() ) {
+    len += 4;
+  }
+  if ( sender_message.SYN and receiver_message.sack_permitted ) {
+    len += 4;
+  }
+
+  return len;
+}
+
+size_t TCPSegment::sack_blocks() const
+{
+  // as many blocks as fit next to the other options (RFC 2018 3)
+  const size_t room = TCPOptionsMaxLen - syn_options_length();
+  const size_t fit = room >= 4 ? ( room - 4 ) / 8 : 0;
+  return min( { receiver_message.sack.size(), TCPReceiverMessage::MAX_SACK_BLOCKS, fit } );
+}
+
+size_t TCPSegment::options_length() const
+{
+  const size_t blocks = sack_blocks();
+  return syn_options_length() + ( blocks ? 4 + 8 * blocks : 0 );
+}
+
+void TCPSegment::serialize_options( Serializer& serializer ) const
+{
+  if ( sender_message.SYN and receiver_message.mss.has_value() ) {
+    serializer.integer( TCPOptionMSS );
+    serializer.integer( uint8_t { 4 } );
+    serializer.integer( receiver_message.mss.value() );
+  }
+
+  if ( sender_message.SYN and receiver_message.window_scale.has_value() ) {
+    serializer.integer( TCPOptionNOP );
+    serializer.integer( TCPOptionWindowScale );
+    serializer.integer( uint8_t { 3 } );
+    serializer.integer( receiver_message.window_scale.value() );
+  }
+
+  if ( sender_message.SYN and receiver_message.sack_permitted ) {
+    serializer.integer( TCPOptionNOP );
+    serializer.integer( TCPOptionNOP );
+    serializer.integer( TCPOptionSACKPermitted );
+    serializer.integer( uint8_t { 2 } );
+  }
+
+  if ( const size_t blocks = sack_blocks(); blocks ) {
+    serializer.integer( TCPOptionNOP );
+    serializer.integer( TCPOptionNOP );
+    serializer.integer( TCPOptionSACK );
+    serializer.integer( static_cast<uint8_t>( 2 + 8 * blocks ) );
+    for ( size_t i = 0; i < blocks; ++i ) {
+      serializer.integer( Wrap32Serializable { receiver_message.sack[i].left }.raw_value() );
+      serializer.integer( Wrap32Serializable { receiver_message.sack[i].right }.raw_value() );
+    }
+  }
+}
+
 void TCPSegment::serialize( Serializer& serializer ) const
 {
   serializer.integer( udinfo.src_port );
   serializer.integer( udinfo.dst_port );
   serializer.integer( Wrap32Serializable { sender_message.seqno }.raw_value() );
   serializer.integer( Wrap32Serializable { receiver_message.ackno.value_or( Wrap32 { 0 } ) }.raw_value() );
-  serializer.integer( uint8_t { TCPHeaderMinLen << 4 } ); // data offset
+  serializer.integer( static_cast<uint8_t>( ( TCPHeaderMinLen + options_length() / 4 ) << 4 ) ); // data offset
   const uint8_t flags = ( receiver_message.ackno.has_value() ? 0b0001'0000U : 0 ) | ( reset ? 0b0000'0100U : 0 )
                         | ( sender_message.SYN ? 0b0000'0010U : 0 ) | ( sender_message.FIN ? 0b0000'0001U : 0 );
   serializer.integer( flags );
   serializer.integer( receiver_message.window_size );
   serializer.integer( udinfo.cksum );
   serializer.integer( uint16_t { 0 } ); // urgent pointer
+  serialize_options( serializer );
   serializer.buffer( sender_message.payload );
 }
 
@@ -16,4 +16,12 @@ struct TCPSegment
   void serialize( Serializer& serializer ) const;
 
   void compute_checksum( uint32_t datagram_layer_pseudo_checksum );
+
+  size_t options_length() const; // in bytes, a multiple of 4
+
+private:
+  void parse_options( Parser& parser, size_t len );
+  size_t syn_options_length() const; // window scale and SACK-permitted, in bytes
+  size_t sack_blocks() const;        // SACK blocks sent, as many as the option space allows
+  void serialize_options( Serializer& serializer ) const;
 };